@@ -29,7 +29,21 @@ DEFINES += QT_DEPRECATED_WARNINGS
 
 SOURCES += \
         main.cpp \
-        preloader_parser.cpp
+        preloader_parser.cpp \
+        emi_batch.cpp \
+        emi_hash.cpp \
+        emi_sink.cpp \
+        emi_writer.cpp \
+        emi_scan.cpp \
+        emi_find.cpp \
+        emi_cache.cpp \
+        emi_blockdev.cpp \
+        emi_daemon.cpp \
+        emi_pipeline.cpp \
+        emi_index.cpp \
+        emi_match.cpp \
+        emi_manifest.cpp \
+        emi_archive.cpp
 
 # Default rules for deployment.
 qnx: target.path = /tmp/$${TARGET}/bin
@@ -44,7 +58,29 @@ win32:{
     DEFINES += "_CRT_SECURE_NO_WARNINGS"
 }
 
+#!zip/gz members are inflated with zlib, on windows point INCLUDEPATH/LIBS at a zlib build.
+LIBS += -lz
+
 HEADERS += \
     emi_structures.h \
-    preloader_parser.h
+    preloader_parser.h \
+    emi_batch.h \
+    emi_hash.h \
+    emi_sink.h \
+    emi_writer.h \
+    emi_scan.h \
+    emi_find.h \
+    emi_cache.h \
+    emi_blockdev.h \
+    emi_daemon.h \
+    emi_pipeline.h \
+    emi_index.h \
+    emi_match.h \
+    emi_manifest.h \
+    emi_archive.h
 
+#!`make bench` builds bench/bench.pro and runs it on the sample blobs in output/ plus
+#!synthetic boot regions, machine readable results land in tmp/bench/bench.json.
+bench.commands = cd $$shell_path($$PWD/bench) && $$QMAKE_QMAKE bench.pro && $(MAKE) && \
+                 $$shell_path($$PWD/tmp/bench/emi_bench) $$shell_path($$PWD/output) 1024 $$shell_path($$PWD/tmp/bench/bench.json)
+QMAKE_EXTRA_TARGETS += bench
@@ -0,0 +1,62 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "preloader_parser.h"
+
+#define BENCH_MIN_NS 50000000 //!run each case for at least 50ms
+
+namespace emiBench {
+
+typedef struct BlobFile
+{
+    qstr name{};
+    qbyte data{};
+}BlobFile;
+
+typedef struct BenchResult
+{
+    qstr name{};
+    double ns{0}; //!per iteration
+    qlong bytes{0}; //!per iteration, 0 => no bytes_per_second
+    qlong items{0}; //!records or cids per iteration, 0 => no ns_per_item
+}BenchResult;
+
+//! kept for write_json(), every bench records its rows here.
+void record(const BenchResult &result);
+void record(const qstr &name, double ns, qlong bytes, qlong items);
+//! {"context":{...},"benchmarks":[{"name","ns_per_iter","bytes_per_second","ns_per_item"}]}
+bool write_json(const qstr &path, const qstr &blob_dir);
+
+//! MTK_BLOADER_INFO_vXX blobs from the given directory (output/ by default).
+QVector<BlobFile> load_blobs(const qstr &dir);
+
+//! average ns per call of fn(), repeated until BENCH_MIN_NS elapsed.
+template <typename Fn>
+double time_ns(Fn fn)
+{
+    QElapsedTimer timer;
+    qlong iters = 0;
+    timer.start();
+    do {
+        fn();
+        iters++;
+    } while (timer.nsecsElapsed() < BENCH_MIN_NS);
+
+    return timer.nsecsElapsed() / (double)iters;
+}
+
+//! EMIParser on the blob files themselves, the MTK_BLOADER_INFO input kind where the blob
+//! is the whole file: Locate() (header check, blob copy), Decode() ns/record and the
+//! full PrasePreloader() a one-shot run pays.
+int bench_decode(const QVector<BlobFile> &blobs);
+
+//! container detection, anchor search and Locate() on each blob wrapped as a plain
+//! preloader and as 4M eMMC (0x800) / UFS (0x1000) boot regions, then Decode()
+//! ns/record and CID decode+render ns/cid per version.
+int bench_parse(const QVector<BlobFile> &blobs);
+
+//! GB/s of every EMIFind kernel on synthetic images from 4MB up to max_size.
+int bench_scan(qlong max_size);
+}
+
+#endif // BENCH_H
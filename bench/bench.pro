@@ -0,0 +1,37 @@
+QT -= gui
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+#get rid of auto generated debug/release folders
+CONFIG -= debug_and_release debug_and_release_target
+
+TARGET = emi_bench
+DESTDIR = ../tmp/bench
+OBJECTS_DIR = $$DESTDIR/.obj
+
+INCLUDEPATH += ..
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+SOURCES += \
+        bench_main.cpp \
+        bench_decode.cpp \
+        bench_scan.cpp \
+        bench_parse.cpp \
+        ../preloader_parser.cpp \
+        ../emi_hash.cpp \
+        ../emi_sink.cpp \
+        ../emi_scan.cpp \
+        ../emi_find.cpp \
+        ../emi_cache.cpp
+
+HEADERS += \
+    bench.h \
+    ../emi_structures.h \
+    ../preloader_parser.h \
+    ../emi_hash.h \
+    ../emi_sink.h \
+    ../emi_scan.h \
+    ../emi_find.h \
+    ../emi_cache.h
@@ -0,0 +1,54 @@
+#include "bench.h"
+
+int emiBench::bench_decode(const QVector<BlobFile> &blobs)
+{
+    qInfo().noquote() << qstr("%0 %1 %2 %3 %4 %5").arg(qstr("blob").leftJustified(22),
+                                                      qstr("records").rightJustified(8),
+                                                      qstr("B/rec").rightJustified(8),
+                                                      qstr("ns(locate)").rightJustified(12),
+                                                      qstr("ns/rec(decode)").rightJustified(15),
+                                                      qstr("ns(parse)").rightJustified(12));
+
+    for (const BlobFile &blob : blobs)
+    {
+        QBuffer emi_dev;
+        emi_dev.setData(blob.data);
+        emi_dev.open(QIODevice::ReadOnly);
+
+        EMIParser parser;
+        QVector<mtkPreloader::MTKEMIInfo> emis = {};
+        if (!parser.Locate(emi_dev))
+            continue; //!no layout for this version
+
+        parser.Decode(emis);
+        if (emis.isEmpty())
+            continue;
+
+        double ns_locate = time_ns([&]() {
+            EMIParser locate_parser;
+            locate_parser.Locate(emi_dev);
+        });
+        double ns_decode = time_ns([&]() {
+            emis.clear();
+            parser.Decode(emis);
+        });
+        double ns_parse = time_ns([&]() {
+            EMIParser parse_parser;
+            QVector<mtkPreloader::MTKEMIInfo> parse_emis = {};
+            parse_parser.PrasePreloader(emi_dev, parse_emis);
+        });
+
+        record(qstr("BM_BlobLocate/%0").arg(blob.name), ns_locate, blob.data.size(), 0);
+        record(qstr("BM_BlobDecode/%0").arg(blob.name), ns_decode, parser.blob().size(), emis.size());
+        record(qstr("BM_BlobParse/%0").arg(blob.name), ns_parse, blob.data.size(), emis.size());
+
+        qInfo().noquote() << qstr("%0 %1 %2 %3 %4 %5").arg(blob.name.leftJustified(22),
+                                                          qstr::number(emis.size()).rightJustified(8),
+                                                          qstr::number(parser.blob().size() / emis.size()).rightJustified(8),
+                                                          qstr::number(ns_locate, 'f', 1).rightJustified(12),
+                                                          qstr::number(ns_decode / emis.size(), 'f', 1).rightJustified(15),
+                                                          qstr::number(ns_parse, 'f', 1).rightJustified(12));
+    }
+
+    return 0;
+}
@@ -0,0 +1,89 @@
+#include "bench.h"
+
+QVector<emiBench::BlobFile> emiBench::load_blobs(const qstr &dir)
+{
+    QVector<BlobFile> blobs = {};
+    QDir blob_dir(dir);
+    for (const qstr &name : blob_dir.entryList(QStringList() << MTK_BLOADER_INFO_BEGIN"*", QDir::Files, QDir::Name))
+    {
+        QFile blob(blob_dir.filePath(name));
+        if (!blob.open(QIODevice::ReadOnly))
+            continue;
+
+        BlobFile blob_file = {};
+        blob_file.name = name;
+        blob_file.data = blob.readAll();
+        blobs.push_back(blob_file);
+    }
+
+    return blobs;
+}
+
+static QVector<emiBench::BenchResult> bench_results = {};
+
+void emiBench::record(const BenchResult &result)
+{
+    bench_results.push_back(result);
+}
+
+void emiBench::record(const qstr &name, double ns, qlong bytes, qlong items)
+{
+    BenchResult result = {};
+    result.name = name;
+    result.ns = ns;
+    result.bytes = bytes;
+    result.items = items;
+    record(result);
+}
+
+bool emiBench::write_json(const qstr &path, const qstr &blob_dir)
+{
+    QFile json(path);
+    if (!json.open(QIODevice::WriteOnly))
+    {
+        qInfo().noquote() << qstr("unable to write results{%0}:%1").arg(path, json.errorString());
+        return 0;
+    }
+
+    //!names and paths are plain ascii here, only quotes and backslashes need escaping.
+    qstr dir = blob_dir;
+    dir.replace("\\", "\\\\").replace("\"", "\\\"");
+
+    qbyte out = {};
+    out += qstr("{\"context\":{\"blob_dir\":\"%0\",\"min_time_ns\":%1},\"benchmarks\":[").arg(dir).arg(BENCH_MIN_NS).toUtf8();
+    for (int idx = 0; idx < bench_results.size(); idx++)
+    {
+        const BenchResult &result = bench_results.at(idx);
+        out += qstr("%0\n{\"name\":\"%1\",\"ns_per_iter\":%2").arg(idx? ",": "", result.name)
+                                                                .arg(result.ns, 0, 'f', 1).toUtf8();
+        if (result.bytes)
+            out += qstr(",\"bytes_per_second\":%0").arg(result.bytes / result.ns * 1e9, 0, 'f', 0).toUtf8();
+        if (result.items)
+            out += qstr(",\"ns_per_item\":%0").arg(result.ns / result.items, 0, 'f', 2).toUtf8();
+        out += "}";
+    }
+    out += "\n]}\n";
+    return json.write(out) == out.size();
+}
+
+//! emi_bench [blob_dir] [max_scan_image_mb] [results.json]
+int main(int argc, char *argv[])
+{
+    qstr blob_dir = (argc > 1)? qstr(argv[1]): qstr("../output");
+    qlong max_scan = ((argc > 2)? qstr(argv[2]).toLongLong(): 8192) << 20; //!8G
+    qstr json_path = (argc > 3)? qstr(argv[3]): qstr();
+
+    QVector<emiBench::BlobFile> blobs = emiBench::load_blobs(blob_dir);
+    if (blobs.isEmpty())
+    {
+        qInfo().noquote() << qstr("no %0* blobs found in %1").arg(MTK_BLOADER_INFO_BEGIN, blob_dir);
+        return 1;
+    }
+
+    if (emiBench::bench_decode(blobs) || emiBench::bench_parse(blobs) || emiBench::bench_scan(max_scan))
+        return 1;
+
+    if (!json_path.isEmpty() && !emiBench::write_json(json_path, blob_dir))
+        return 1;
+    return 0;
+}
@@ -0,0 +1,194 @@
+#include "bench.h"
+
+#define PL_CONTENT_OFF 0x300
+#define PL_SIG_LEN 0x100
+#define BOOT_IMAGE_LEN (4LL << 20) //!boot0 / LUN0 dump size around the preloader
+
+enum BenchContainer
+{
+    BENCH_PRELOADER = 0,
+    BENCH_EMMC_BOOT = 1, //!preloader at 0x800
+    BENCH_UFS_LUN = 2, //!preloader at 0x1000
+};
+
+static const char *container_name(int container)
+{
+    static const char *names[] = {"pl", "emmc", "ufs"};
+    return names[container];
+}
+
+//! minimal preloader around the blob: gfh, the platform path the soc is read from,
+//! the blob and its length right in front of the signature.
+static qbyte make_preloader(const qbyte &blob)
+{
+    qbyte image(PL_CONTENT_OFF, 0x00);
+    image.append("bootable/bootloader/preloader/platform/mt6765/src");
+    image.append(qbyte(0x100, 0x00));
+    image.append(blob);
+    quint blob_len = blob.size();
+    image.append((const char*)&blob_len, sizeof(blob_len));
+
+    mtkPreloader::gfh_info_t gfh = {};
+    gfh.magic = 0x14d4d4d;
+    gfh.size = sizeof(gfh);
+    memcpy(gfh.id, "FILE_INFO", 9);
+    gfh.file_version = 1;
+    gfh.flash_dev = 5;
+    gfh.sig_type = 1;
+    gfh.load_addr = 0x201000;
+    gfh.length = image.size() + PL_SIG_LEN;
+    gfh.max_size = 0x40000;
+    gfh.content_offset = PL_CONTENT_OFF;
+    gfh.sig_length = PL_SIG_LEN;
+    gfh.jump_offset = PL_CONTENT_OFF;
+    memcpy(image.data(), &gfh, sizeof(gfh));
+
+    image.append(qbyte(PL_SIG_LEN, 0x00));
+    return image;
+}
+
+static qbyte make_image(const qbyte &blob, int container)
+{
+    qbyte preloader = make_preloader(blob);
+    if (container == BENCH_PRELOADER)
+        return preloader;
+
+    qsizetype pl_off = (container == BENCH_UFS_LUN)? 0x1000: 0x800;
+    qbyte image(pl_off, 0x00);
+    if (container == BENCH_UFS_LUN)
+        memcpy(image.data(), "UFS_LUN0", 8);
+    else
+        memcpy(image.data(), "EMMC_BOOT", 9);
+    image[0x20] = 1;
+    image.append(preloader);
+    image.append(qbyte(qMax<qlong>(BOOT_IMAGE_LEN - image.size(), 0), 0x00));
+    return image;
+}
+
+//! the header checks PrasePreloader starts with: map + gfh (+ boot region gfh).
+static quint detect_container(QIODevice &emi_dev)
+{
+    EMIImage image(emi_dev);
+    mtkPreloader::gfh_info_t gfh = {};
+    if (!image.Fill(sizeof(gfh)))
+        return 0;
+    memcpy(&gfh, image.view().constData(), sizeof(gfh));
+
+    if (gfh.magic == 0x434d4d45 || gfh.magic == 0x5f534655) //!EMMC_BOOT0, UFS_LUN0
+    {
+        qsizetype seek_off = (gfh.magic == 0x5f534655)? 0x1000: 0x800;
+        if (!image.Fill(seek_off + sizeof(gfh)))
+            return 0;
+        memcpy(&gfh, image.view().constData() + seek_off, sizeof(gfh));
+    }
+    return gfh.magic;
+}
+
+static void print_row(const emiBench::BenchResult &result)
+{
+    qstr bytes_per_second = result.bytes? qstr("%0 MB/s").arg(result.bytes / result.ns * 1e3, 0, 'f', 1): qstr("-");
+    qstr ns_per_item = result.items? qstr("%0 ns").arg(result.ns / result.items, 0, 'f', 1): qstr("-");
+    qInfo().noquote() << qstr("%0 %1 %2 %3").arg(result.name.leftJustified(32),
+                                                 qstr("%0 us").arg(result.ns / 1e3, 0, 'f', 3).rightJustified(14),
+                                                 bytes_per_second.rightJustified(18),
+                                                 ns_per_item.rightJustified(14));
+    emiBench::record(result);
+}
+
+int emiBench::bench_parse(const QVector<BlobFile> &blobs)
+{
+    qInfo("-------------------------------------------------------------------------------");
+    qInfo().noquote() << qstr("%0 %1 %2 %3").arg(qstr("Benchmark").leftJustified(32),
+                                                 qstr("Time").rightJustified(14),
+                                                 qstr("bytes_per_second").rightJustified(18),
+                                                 qstr("ns_per_item").rightJustified(14));
+    qInfo("-------------------------------------------------------------------------------");
+
+    for (const BlobFile &blob : blobs)
+    {
+        qstr ver = blob.name.mid(strlen(MTK_BLOADER_INFO_BEGIN) - 1); //!vXX
+
+        for (int container = BENCH_PRELOADER; container <= BENCH_UFS_LUN; container++)
+        {
+            //!a real file, EMIImage maps it like a dump on disk.
+            QTemporaryFile file;
+            qbyte image = make_image(blob.data, container);
+            if (!file.open() || file.write(image) != image.size() || !file.flush())
+            {
+                qInfo().noquote() << qstr("unable to write image{%0}:%1").arg(file.fileName(), file.errorString());
+                return 1;
+            }
+
+            if (detect_container(file) != 0x14d4d4d)
+            {
+                qInfo().noquote() << qstr("BM_Detect/%0/%1: no preloader found").arg(container_name(container), ver);
+                return 1;
+            }
+
+            BenchResult detect = {};
+            detect.name = qstr("BM_Detect/%0/%1").arg(container_name(container), ver);
+            detect.ns = time_ns([&]() { detect_container(file); });
+            print_row(detect);
+
+            //!the whole image, what a single pass costs without the boot region limit.
+            EMIAnchors anchors = {};
+            BenchResult anchor = {};
+            anchor.name = qstr("BM_Anchor/%0/%1").arg(container_name(container), ver);
+            anchor.bytes = image.size();
+            anchor.ns = time_ns([&]() {
+                anchors = EMIAnchors();
+                FindEMIAnchors(image, anchors);
+            });
+            print_row(anchor);
+
+            qint64 scanned = 0;
+            BenchResult locate = {};
+            locate.name = qstr("BM_Locate/%0/%1").arg(container_name(container), ver);
+            locate.ns = time_ns([&]() {
+                EMIParser parser;
+                parser.Locate(file);
+                scanned = parser.scanned();
+            });
+            locate.bytes = scanned;
+            print_row(locate);
+        }
+
+        QBuffer preloader;
+        preloader.setData(make_preloader(blob.data));
+        preloader.open(QIODevice::ReadOnly);
+        EMIParser parser;
+        QVector<mtkPreloader::MTKEMIInfo> emis = {};
+        if (!parser.Locate(preloader))
+            continue; //!no layout for this version
+
+        parser.Decode(emis);
+        if (emis.isEmpty())
+            continue;
+
+        BenchResult decode = {};
+        decode.name = qstr("BM_Decode/%0").arg(ver);
+        decode.bytes = parser.blob().size();
+        decode.items = emis.size();
+        decode.ns = time_ns([&]() {
+            emis.clear();
+            parser.Decode(emis);
+        });
+        print_row(decode);
+
+        BenchResult cid = {};
+        cid.name = qstr("BM_CID/%0").arg(ver);
+        cid.items = emis.size();
+        cid.ns = time_ns([&]() {
+            for (const mtkPreloader::MTKEMIInfo &emi : emis)
+            {
+                mmcCARD::CIDData cid_data = {};
+                mmcCARD::CIDInfo cid_info = {};
+                EMIParser::DecodeCID(emi.flash_id, emi.id_len, emi.is_ufs, cid_data);
+                EMIParser::RenderCID(cid_data, cid_info);
+            }
+        });
+        print_row(cid);
+    }
+
+    return 0;
+}
@@ -0,0 +1,73 @@
+#include "bench.h"
+#include "emi_find.h"
+
+#define SCAN_WINDOW (128LL << 20) //!bigger images are streamed through one window of this size
+#define SCAN_MIN_IMAGE (4LL << 20)
+
+//! dump-like filler: random bytes with every 4th 4K page zeroed (padding),
+//! the anchor sits at the very end so every kernel has to walk all of it.
+static qbyte make_window(qlong size)
+{
+    qbyte window(size, Qt::Uninitialized);
+    qlong seed = 0x9e3779b97f4a7c15ULL;
+    for (qlong idx = 0; idx + 8 <= size; idx += 8)
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        qlong word = ((idx >> 12) & 3) == 3? 0: seed;
+        memcpy(window.data() + idx, &word, sizeof(word));
+    }
+
+    qsizetype anchor_len = strlen(MTK_BLOADER_INFO_BEGIN);
+    memcpy(window.data() + size - anchor_len - 2, MTK_BLOADER_INFO_BEGIN"39", anchor_len + 2);
+    return window;
+}
+
+static qstr size_name(qlong size)
+{
+    if (size >= (1LL << 30))
+        return qstr("%0G").arg(size >> 30);
+    return qstr("%0M").arg(size >> 20);
+}
+
+int emiBench::bench_scan(qlong max_size)
+{
+    const char *anchor = MTK_BLOADER_INFO_BEGIN;
+    qsizetype anchor_len = strlen(anchor);
+
+    qInfo("------------------------------------------------------------------");
+    qInfo().noquote() << qstr("%0 %1 %2").arg(qstr("Benchmark").leftJustified(32),
+                                             qstr("Time").rightJustified(14),
+                                             qstr("bytes_per_second").rightJustified(18));
+    qInfo("------------------------------------------------------------------");
+
+    for (qlong size = SCAN_MIN_IMAGE; size <= max_size; size *= 2)
+    {
+        qlong window_len = qMin<qlong>(size, SCAN_WINDOW);
+        qbyte window = make_window(window_len);
+        qlong tiles = size / window_len;
+
+        for (const EMIFindKernel &kernel : EMIFindKernels())
+        {
+            qsizetype found = -1;
+            double ns = time_ns([&]() {
+                for (qlong tile = 0; tile < tiles; tile++)
+                    found = kernel.find(window.constData(), window.size(), anchor, anchor_len);
+            });
+
+            if (found != window.size() - anchor_len - 2)
+            {
+                qInfo().noquote() << qstr("BM_FindAnchor/%0/%1: anchor not found").arg(kernel.name, size_name(size));
+                return 1;
+            }
+
+            record(qstr("BM_FindAnchor/%0/%1").arg(kernel.name, size_name(size)), ns, size, 0);
+            qInfo().noquote() << qstr("%0 %1 %2").arg(qstr("BM_FindAnchor/%0/%1").arg(kernel.name, size_name(size)).leftJustified(32),
+                                                     qstr("%0 ms").arg(ns / 1e6, 0, 'f', 3).rightJustified(14),
+                                                     qstr("%0 GB/s").arg(size / ns, 0, 'f', 2).rightJustified(18));
+        }
+    }
+
+    return 0;
+}
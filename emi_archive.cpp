@@ -0,0 +1,496 @@
+#include "emi_archive.h"
+
+#include <zlib.h>
+
+#define EMI_TAR_BLOCK 0x200
+
+struct EMIInflateState
+{
+    z_stream zs;
+};
+
+typedef struct EMIZipMember
+{
+    qstr name{};
+    qint64 local_off{0}; //!local file header
+    qint64 comp_size{0};
+    qint64 size{0};
+    quint16 method{0}; //!0 stored, 8 deflate
+    bool encrypted{0}; //!general purpose flag bit 0
+} EMIZipMember;
+
+EMIRangeDevice::EMIRangeDevice(QIODevice *source, qint64 off, qint64 len, QObject *parent) :
+    QIODevice(parent), m_source(source), m_off(off), m_len(len)
+{
+}
+
+EMIRangeDevice::~EMIRangeDevice()
+{
+    close();
+}
+
+bool EMIRangeDevice::open(OpenMode mode)
+{
+    if (isOpen() || (mode & WriteOnly))
+    {
+        setErrorString("read only");
+        return 0;
+    }
+
+    if (!m_source->isOpen() && !m_source->open(QIODevice::ReadOnly))
+    {
+        setErrorString(m_source->errorString());
+        return 0;
+    }
+    if (!m_source->isSequential() && !m_source->seek(m_off))
+    {
+        setErrorString(qstr("unable to seek to %0").arg(m_off));
+        return 0;
+    }
+    m_pos = 0;
+    return QIODevice::open(mode | Unbuffered);
+}
+
+void EMIRangeDevice::close()
+{
+    if (m_source)
+        m_source->close();
+    QIODevice::close();
+}
+
+bool EMIRangeDevice::seek(qint64 pos)
+{
+    if (isSequential() || pos < 0 || pos > m_len || !m_source->seek(m_off + pos))
+        return 0;
+    m_pos = pos;
+    return QIODevice::seek(pos);
+}
+
+qint64 EMIRangeDevice::readData(char *data, qint64 maxlen)
+{
+    maxlen = qMin(maxlen, m_len - m_pos);
+    if (maxlen <= 0)
+        return 0;
+
+    qint64 read_len = m_source->read(data, maxlen);
+    if (read_len > 0)
+        m_pos += read_len;
+    return read_len;
+}
+
+EMIInflateDevice::EMIInflateDevice(QIODevice *source, bool raw_deflate, QObject *parent) :
+    QIODevice(parent), m_source(source), m_raw(raw_deflate)
+{
+}
+
+EMIInflateDevice::~EMIInflateDevice()
+{
+    close();
+}
+
+bool EMIInflateDevice::open(OpenMode mode)
+{
+    if (isOpen() || (mode & WriteOnly))
+    {
+        setErrorString("read only");
+        return 0;
+    }
+
+    if (!m_source->isOpen() && !m_source->open(QIODevice::ReadOnly))
+    {
+        setErrorString(m_source->errorString());
+        return 0;
+    }
+
+    m_state.reset(new EMIInflateState);
+    memset(&m_state->zs, 0x00, sizeof(m_state->zs));
+    //!-15 => raw deflate, 15 + 16 => gzip header and trailer.
+    if (inflateInit2(&m_state->zs, m_raw? -MAX_WBITS: MAX_WBITS + 16) != Z_OK)
+    {
+        setErrorString("unable to init zlib");
+        m_state.reset();
+        return 0;
+    }
+    m_end = 0;
+    return QIODevice::open(mode | Unbuffered);
+}
+
+void EMIInflateDevice::close()
+{
+    if (m_state)
+        inflateEnd(&m_state->zs);
+    m_state.reset();
+    m_in.clear();
+    if (m_source)
+        m_source->close();
+    QIODevice::close();
+}
+
+qint64 EMIInflateDevice::readData(char *data, qint64 maxlen)
+{
+    if (!m_state || m_end)
+        return 0;
+
+    z_stream &zs = m_state->zs;
+    zs.next_out = (Bytef*)data;
+    zs.avail_out = (uInt)qMin<qint64>(maxlen, 0x40000000);
+    uInt want = zs.avail_out;
+
+    //!at least one byte out or the end of the stream.
+    while (zs.avail_out == want)
+    {
+        if (!zs.avail_in)
+        {
+            m_in.resize(EMI_INFLATE_CHUNK);
+            qint64 read_len = m_source->read(m_in.data(), m_in.size());
+            if (read_len <= 0)
+            {
+                m_end = 1;
+                break;
+            }
+            zs.next_in = (Bytef*)m_in.data();
+            zs.avail_in = (uInt)read_len;
+        }
+
+        int ret = inflate(&zs, Z_NO_FLUSH);
+        if (ret == Z_STREAM_END)
+        {
+            //!concatenated gzip members read as one stream, a zip member ends here.
+            if (m_raw || inflateReset(&zs) != Z_OK)
+            {
+                m_end = 1;
+                break;
+            }
+            continue;
+        }
+        if (ret != Z_OK && ret != Z_BUF_ERROR)
+        {
+            setErrorString(qstr("inflate:%0").arg(zs.msg? zs.msg: "stream error"));
+            m_end = 1;
+            if (zs.avail_out == want)
+                return -1;
+            break;
+        }
+    }
+    return want - zs.avail_out;
+}
+
+static bool has_suffix(const qstr &path, const char *suffix)
+{
+    return path.endsWith(QLatin1String(suffix), Qt::CaseInsensitive);
+}
+
+static bool is_tar_gz(const qstr &path)
+{
+    return has_suffix(path, ".tar.gz") || has_suffix(path, ".tgz");
+}
+
+//!octal, or base-256 with the high bit set for members past 8G.
+static qint64 tar_number(const char *field, int len)
+{
+    if ((qchar)field[0] & 0x80)
+    {
+        qint64 num = field[0] & 0x7f;
+        for (int idx = 1; idx < len; idx++)
+            num = (num << 8) | (qchar)field[idx];
+        return num;
+    }
+
+    qint64 num = 0;
+    for (int idx = 0; idx < len && field[idx]; idx++)
+    {
+        if (field[idx] == ' ')
+            continue;
+        if (field[idx] < '0' || field[idx] > '7')
+            return -1;
+        num = (num << 3) | (field[idx] - '0');
+    }
+    return num;
+}
+
+static inline qint64 tar_padded(qint64 len)
+{
+    return (len + EMI_TAR_BLOCK - 1) & ~(qint64)(EMI_TAR_BLOCK - 1);
+}
+
+//!next regular file from the current position, its data follows; 0 => end or not a tar.
+static bool next_tar_member(QIODevice &tar, qstr &name, qint64 &size)
+{
+    qbyte long_name = {};
+    forever
+    {
+        char hdr[EMI_TAR_BLOCK];
+        if (tar.read(hdr, sizeof(hdr)) != (qint64)sizeof(hdr) || !hdr[0])
+            return 0;
+
+        quint checksum = 0;
+        for (int idx = 0; idx < EMI_TAR_BLOCK; idx++)
+            checksum += (idx >= 148 && idx < 156)? ' ': (qchar)hdr[idx];
+        qint64 len = tar_number(hdr + 124, 12);
+        if (len < 0 || tar_number(hdr + 148, 8) != checksum)
+            return 0;
+
+        char type = hdr[156];
+        if (type == 'L') //!gnu long name, the next header is the file.
+        {
+            long_name = tar.read(len);
+            if (long_name.size() != len || tar.skip(tar_padded(len) - len) != tar_padded(len) - len)
+                return 0;
+            continue;
+        }
+
+        if (type == '0' || type == '\0' || type == '7')
+        {
+            qbyte hdr_name(hdr, qstrnlen(hdr, 100));
+            if (!memcmp(hdr + 257, "ustar", 5) && hdr[345])
+                hdr_name = qbyte(hdr + 345, qstrnlen(hdr + 345, 155)) + "/" + hdr_name;
+            name = QFile::decodeName(long_name.isEmpty()? hdr_name: long_name.left(qstrnlen(long_name.constData(), long_name.size())));
+            size = len;
+            return 1;
+        }
+
+        long_name.clear();
+        if (tar.skip(tar_padded(len)) != tar_padded(len))
+            return 0;
+    }
+}
+
+static bool read_zip_members(QFile &zip, QVector<EMIZipMember> &members, qstr &error)
+{
+    //!end of central directory: the last 22 bytes plus a comment of up to 64K.
+    qint64 zip_size = zip.size();
+    qint64 tail_len = qMin<qint64>(zip_size, 0xffff + 22);
+    qbyte tail = (zip.seek(zip_size - tail_len))? zip.read(tail_len): qbyte();
+
+    qsizetype eocd = -1;
+    for (qsizetype idx = tail.size() - 22; idx >= 0 && eocd == -1; idx--)
+    {
+        if (qFromLittleEndian<quint>(tail.constData() + idx) == 0x06054b50)
+            eocd = idx;
+    }
+    if (eocd == -1)
+    {
+        error = "no zip central directory";
+        return 0;
+    }
+
+    const char *end = tail.constData() + eocd;
+    qint64 entries = qFromLittleEndian<quint16>(end + 10);
+    qint64 cd_len = qFromLittleEndian<quint>(end + 12);
+    qint64 cd_off = qFromLittleEndian<quint>(end + 16);
+    if (eocd >= 20 && qFromLittleEndian<quint>(end - 20) == 0x07064b50) //!zip64 locator
+    {
+        qbyte end64 = zip.seek(qFromLittleEndian<qlong>(end - 20 + 8))? zip.read(56): qbyte();
+        if (end64.size() == 56 && qFromLittleEndian<quint>(end64.constData()) == 0x06064b50)
+        {
+            entries = qFromLittleEndian<qlong>(end64.constData() + 32);
+            cd_len = qFromLittleEndian<qlong>(end64.constData() + 40);
+            cd_off = qFromLittleEndian<qlong>(end64.constData() + 48);
+        }
+    }
+
+    qbyte cd = (cd_off >= 0 && cd_len >= 0 && cd_off + cd_len <= zip_size && zip.seek(cd_off))? zip.read(cd_len): qbyte();
+    if (cd.size() != cd_len)
+    {
+        error = "truncated zip central directory";
+        return 0;
+    }
+
+    qsizetype pos = 0;
+    for (qint64 entry = 0; entry < entries; entry++)
+    {
+        const char *hdr = cd.constData() + pos;
+        if (pos + 46 > cd.size() || qFromLittleEndian<quint>(hdr) != 0x02014b50)
+        {
+            error = "broken zip central directory";
+            return 0;
+        }
+        quint16 name_len = qFromLittleEndian<quint16>(hdr + 28);
+        quint16 extra_len = qFromLittleEndian<quint16>(hdr + 30);
+        quint16 comment_len = qFromLittleEndian<quint16>(hdr + 32);
+        if (pos + 46 + name_len + extra_len + comment_len > cd.size())
+        {
+            error = "broken zip central directory";
+            return 0;
+        }
+
+        EMIZipMember member = {};
+        member.encrypted = qFromLittleEndian<quint16>(hdr + 8) & 0x01;
+        member.method = qFromLittleEndian<quint16>(hdr + 10);
+        member.comp_size = qFromLittleEndian<quint>(hdr + 20);
+        member.size = qFromLittleEndian<quint>(hdr + 24);
+        member.local_off = qFromLittleEndian<quint>(hdr + 42);
+        member.name = QFile::decodeName(qbyte(hdr + 46, name_len));
+
+        //!zip64 extra field: 64bit values for the fields that are 0xffffffff, in this order.
+        const char *extra = hdr + 46 + name_len;
+        for (quint16 off = 0; off + 4 <= extra_len;)
+        {
+            quint16 id = qFromLittleEndian<quint16>(extra + off);
+            quint16 len = qFromLittleEndian<quint16>(extra + off + 2);
+            if (id == 0x0001)
+            {
+                const char *val = extra + off + 4;
+                const char *val_end = val + qMin<quint16>(len, extra_len - off - 4);
+                qint64 *fields[] = {&member.size, &member.comp_size, &member.local_off};
+                for (qint64 *field : fields)
+                {
+                    if (*field != 0xffffffff || val + 8 > val_end)
+                        continue;
+                    *field = qFromLittleEndian<qlong>(val);
+                    val += 8;
+                }
+            }
+            off += 4 + len;
+        }
+
+        if (!member.name.endsWith('/')) //!directories
+            members.push_back(member);
+        pos += 46 + name_len + extra_len + comment_len;
+    }
+    return 1;
+}
+
+bool EMIArchive::IsArchive(const qstr &path)
+{
+    return has_suffix(path, ".zip") || has_suffix(path, ".tar") || has_suffix(path, ".gz") || has_suffix(path, ".tgz");
+}
+
+bool EMIArchive::SplitPath(const qstr &path, qstr &archive, qstr &member)
+{
+    for (qsizetype idx = path.indexOf(EMI_ARCHIVE_SEP); idx != -1; idx = path.indexOf(EMI_ARCHIVE_SEP, idx + 1))
+    {
+        if (IsArchive(path.left(idx)) && QFileInfo(path.left(idx)).isFile())
+        {
+            archive = path.left(idx);
+            member = path.mid(idx + strlen(EMI_ARCHIVE_SEP));
+            return 1;
+        }
+    }
+    return 0;
+}
+
+QStringList EMIArchive::ListMembers(const qstr &path)
+{
+    QStringList paths = {};
+    QFile archive(path);
+    if (is_tar_gz(path) || has_suffix(path, ".gz") || !archive.open(QIODevice::ReadOnly))
+        return QStringList() << path;
+
+    if (has_suffix(path, ".zip"))
+    {
+        QVector<EMIZipMember> members = {};
+        qstr error = {};
+        if (read_zip_members(archive, members, error))
+        {
+            for (const EMIZipMember &member : members)
+                paths << path + EMI_ARCHIVE_SEP + member.name;
+        }
+    }
+    else
+    {
+        qstr name = {};
+        qint64 size = 0;
+        while (next_tar_member(archive, name, size) && archive.seek(archive.pos() + tar_padded(size)))
+            paths << path + EMI_ARCHIVE_SEP + name;
+    }
+
+    //!broken or empty => the archive itself, opening it tells why.
+    return paths.isEmpty()? QStringList() << path: paths;
+}
+
+QIODevice *EMIArchive::Open(const qstr &path, qstr &error)
+{
+    qstr archive_path = path;
+    qstr member_name = {};
+    SplitPath(path, archive_path, member_name);
+
+    QScopedPointer<QFile> archive(new QFile(archive_path));
+    if (!archive->open(QIODevice::ReadOnly))
+    {
+        error = archive->errorString();
+        return nullptr;
+    }
+
+    if (has_suffix(archive_path, ".zip"))
+    {
+        QVector<EMIZipMember> members = {};
+        if (!read_zip_members(*archive, members, error))
+            return nullptr;
+        if (member_name.isEmpty()) //!the archive itself: ListMembers() found no files in it.
+        {
+            error = members.isEmpty()? qstr("no files in zip archive"): qstr("no member named, use %0%1<member>").arg(archive_path, EMI_ARCHIVE_SEP);
+            return nullptr;
+        }
+
+        for (const EMIZipMember &member : members)
+        {
+            if (member.name != member_name)
+                continue;
+
+            char local[30];
+            if (!archive->seek(member.local_off) || archive->read(local, sizeof(local)) != (qint64)sizeof(local)
+                    || qFromLittleEndian<quint>(local) != 0x04034b50)
+            {
+                error = qstr("broken zip member{%0}").arg(member.name);
+                return nullptr;
+            }
+            if (member.encrypted)
+            {
+                error = qstr("encrypted zip member{%0}").arg(member.name);
+                return nullptr;
+            }
+            if (member.method != 0 && member.method != 8)
+            {
+                error = qstr("unsupported zip compression{%0}:%1").arg(member.name).arg(member.method);
+                return nullptr;
+            }
+
+            qint64 data_off = member.local_off + sizeof(local) + qFromLittleEndian<quint16>(local + 26) + qFromLittleEndian<quint16>(local + 28);
+            QIODevice *data = new EMIRangeDevice(archive.take(), data_off, member.comp_size);
+            return (member.method == 8)? (QIODevice*)new EMIInflateDevice(data, 1): data;
+        }
+        error = qstr("no such zip member{%0}").arg(member_name);
+        return nullptr;
+    }
+
+    bool tar = has_suffix(archive_path, ".tar") || is_tar_gz(archive_path);
+    QScopedPointer<QIODevice> stream;
+    if (has_suffix(archive_path, ".gz") || has_suffix(archive_path, ".tgz"))
+    {
+        //!not gzip after all => a dump that happens to be named so.
+        char magic[2] = {};
+        bool gzip = archive->read(magic, sizeof(magic)) == (qint64)sizeof(magic) && (qchar)magic[0] == 0x1f && (qchar)magic[1] == 0x8b;
+        archive->close(); //!handed back unopened, the caller opens (and maps) it.
+        if (!gzip)
+            return archive.take();
+
+        stream.reset(new EMIInflateDevice(archive.take(), 0));
+        if (!tar)
+            return stream.take();
+        if (!stream->open(QIODevice::ReadOnly))
+        {
+            error = stream->errorString();
+            return nullptr;
+        }
+    }
+    else
+    {
+        stream.reset(archive.take());
+    }
+
+    qstr name = {};
+    qint64 size = 0;
+    while (next_tar_member(*stream, name, size))
+    {
+        if (member_name.isEmpty() || name == member_name)
+        {
+            qint64 data_off = stream->isSequential()? 0: stream->pos();
+            return new EMIRangeDevice(stream.take(), data_off, size);
+        }
+        if (stream->skip(tar_padded(size)) != tar_padded(size))
+            break;
+    }
+    error = member_name.isEmpty()? qstr("no file in tar archive"): qstr("no such tar member{%0}").arg(member_name);
+    return nullptr;
+}
@@ -0,0 +1,79 @@
+#ifndef EMI_ARCHIVE_H
+#define EMI_ARCHIVE_H
+
+#include "emi_structures.h"
+
+#define EMI_ARCHIVE_SEP "!/" //!dumps.zip!/lun0.bin names one archive member
+#define EMI_INFLATE_CHUNK 0x10000 //!compressed bytes read per refill
+
+struct EMIInflateState;
+
+//! [off, off + len) of another device, owned. a seekable source is seeked to off on open,
+//! a sequential one is taken as it stands (off is then already consumed).
+class EMIRangeDevice : public QIODevice
+{
+public:
+    EMIRangeDevice(QIODevice *source, qint64 off, qint64 len, QObject *parent = nullptr);
+    ~EMIRangeDevice() override;
+
+    bool open(OpenMode mode) override; //!ReadOnly only
+    void close() override;
+    bool isSequential() const override { return m_source->isSequential(); }
+    qint64 size() const override { return m_len; }
+    bool seek(qint64 pos) override;
+protected:
+    qint64 readData(char *data, qint64 maxlen) override;
+    qint64 writeData(const char *, qint64) override { return -1; }
+private:
+    Q_DISABLE_COPY(EMIRangeDevice)
+
+    QScopedPointer<QIODevice> m_source;
+    qint64 m_off{0};
+    qint64 m_len{0};
+    qint64 m_pos{0}; //!pos() means nothing on sequential devices
+};
+
+//! zlib stream over another device, owned: gzip (concatenated members too) or the raw
+//! deflate data of a zip member. inflates only as far as it is read, a parser that
+//! stops after the preloader leaves the rest of a multi GB dump compressed.
+class EMIInflateDevice : public QIODevice
+{
+public:
+    EMIInflateDevice(QIODevice *source, bool raw_deflate, QObject *parent = nullptr);
+    ~EMIInflateDevice() override;
+
+    bool open(OpenMode mode) override; //!ReadOnly only
+    void close() override;
+    bool isSequential() const override { return 1; }
+protected:
+    qint64 readData(char *data, qint64 maxlen) override;
+    qint64 writeData(const char *, qint64) override { return -1; }
+private:
+    Q_DISABLE_COPY(EMIInflateDevice)
+
+    QScopedPointer<QIODevice> m_source;
+    QScopedPointer<EMIInflateState> m_state;
+    bool m_raw{0};
+    bool m_end{0};
+    qbyte m_in{};
+};
+
+//! dumps inside .zip, .tar, .gz and .tar.gz / .tgz archives, read without extracting them.
+//!   zip    : members listed from the central directory (zip64 too), stored or deflated
+//!   tar    : members listed by hopping from header to header, their data isn't read
+//!   gz     : one stream
+//!   tar.gz : only reachable by inflating all that lies in front of a member, so the
+//!            archive is read as its first regular file, the dump it was made for
+class EMIArchive
+{
+public:
+    static bool IsArchive(const qstr &path); //!by extension
+    //!member paths (archive EMI_ARCHIVE_SEP name), the archive itself where it isn't listed.
+    static QStringList ListMembers(const qstr &path);
+    //!splits a member path, 0 => not one.
+    static bool SplitPath(const qstr &path, qstr &archive, qstr &member);
+    //!unopened device over an archive or member path, nullptr => error says why.
+    static QIODevice *Open(const qstr &path, qstr &error);
+};
+
+#endif // EMI_ARCHIVE_H
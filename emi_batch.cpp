@@ -0,0 +1,121 @@
+#include "emi_batch.h"
+#include "emi_writer.h"
+#include "emi_blockdev.h"
+#include "emi_archive.h"
+
+EMIBatchScanner::EMIBatchScanner(int jobs)
+{
+    m_jobs = (jobs > 0)?jobs: QThread::idealThreadCount();
+}
+
+QIODevice *EMIBatchScanner::OpenInput(const qstr &path, EMIScanResult &result) const
+{
+    result.path = path;
+
+    //!block devices always bypass the page cache, files only when asked to.
+    QScopedPointer<QIODevice> emi_dev;
+    EMIBlockDevice *block_dev = nullptr;
+    qstr archive = {};
+    qstr member = {};
+    if (EMIArchive::IsArchive(path) || EMIArchive::SplitPath(path, archive, member))
+    {
+        //!streamed out of the archive, nothing is extracted to disk.
+        qstr error = {};
+        emi_dev.reset(EMIArchive::Open(path, error));
+        if (!emi_dev)
+        {
+            result.messages << qstr("unable to open file{%0}:%1").arg(path, error);
+            return nullptr;
+        }
+    }
+    else if (m_direct_io || EMIBlockDevice::IsBlockDevice(path))
+    {
+        block_dev = new EMIBlockDevice(path);
+        emi_dev.reset(block_dev);
+    }
+    else
+        emi_dev.reset(new QFile(path));
+
+    if (!emi_dev->isOpen() && !emi_dev->open(QIODevice::ReadOnly))
+    {
+        result.messages << qstr("unable to open file{%0}:%1").arg(path, emi_dev->errorString());
+        return nullptr;
+    }
+
+    if (block_dev && !block_dev->isDirect())
+        result.messages << qstr("no O_DIRECT for file{%0}:read through the page cache").arg(path);
+    result.opened = 1;
+    return emi_dev.take();
+}
+
+void EMIBatchScanner::ScanFile(const qstr &path, EMIScanResult &result) const
+{
+    QScopedPointer<QIODevice> emi_dev(OpenInput(path, result));
+    if (emi_dev)
+        ScanDevice(*emi_dev, result);
+    else if (m_writer)
+        m_writer->Format(result, result.output);
+}
+
+void EMIBatchScanner::ScanDevice(QIODevice &emi_dev, EMIScanResult &result) const
+{
+    result.opened = 1;
+
+    EMIParser parser;
+    parser.setBlobSink(m_sink);
+    parser.setCache(m_cache);
+    parser.PrasePreloader(emi_dev, result.emis);
+    result.messages << parser.messages(); //!after what OpenInput noted
+    result.header = parser.header();
+    result.blob = parser.blob();
+
+    if (m_writer)
+        m_writer->Format(result, result.output);
+}
+
+QStringList EMIBatchScanner::ExpandInputs(const QStringList &inputs)
+{
+    QStringList files = {};
+    for (const qstr &input : inputs)
+    {
+        QFileInfo info(input);
+        QStringList found = {};
+
+        if (info.isDir())
+        {
+            QDirIterator it(input, QDir::Files, QDirIterator::Subdirectories);
+            while (it.hasNext())
+                found << it.next();
+        }
+        else if (!info.exists()
+                 && (input.contains("*") || input.contains("?") || input.contains("[")))
+        {
+            QDirIterator it(info.path(), QStringList() << info.fileName(), QDir::Files);
+            while (it.hasNext())
+                found << it.next();
+        }
+        else
+        {
+            found << input;
+        }
+
+        found.sort(); //!QDirIterator order is filesystem order.
+        for (const qstr &path : found)
+        {
+            //!an archive stands for the dumps inside it.
+            if (EMIArchive::IsArchive(path) && QFileInfo(path).isFile())
+                files << EMIArchive::ListMembers(path);
+            else
+                files << path;
+        }
+    }
+
+    return files;
+}
+
+void EMIBatchScanner::Scan(const QStringList &files, const std::function<void(const EMIScanResult &)> &on_result)
+{
+    EMIScanPipeline pipeline(*this);
+    pipeline.Run(files, on_result);
+    m_stats = pipeline.stats();
+}
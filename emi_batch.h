@@ -0,0 +1,72 @@
+#ifndef EMI_BATCH_H
+#define EMI_BATCH_H
+
+#include "preloader_parser.h"
+#include "emi_pipeline.h"
+
+#include <functional>
+
+class EMIWriter;
+
+//!per input outcome, worse is higher.
+enum EMIScanStatus
+{
+    EMI_SCAN_OK = 0, //!emi records found
+    EMI_SCAN_NO_EMI = 1, //!read but holds no (supported) emi info
+    EMI_SCAN_UNREADABLE = 2, //!could not be opened
+};
+
+typedef struct EMIScanResult
+{
+    qstr path{};
+    bool opened{0}; //!0 => the input could not be opened
+    QStringList messages{};
+    mtkPreloader::MTKEMIHeader header{};
+    QVector<mtkPreloader::MTKEMIInfo> emis{};
+    qbyte blob{}; //!MTK_BLOADER_INFO the emis point into
+    qbyte output{}; //!formatted by the worker when a writer is set.
+
+    EMIScanStatus status() const
+    {
+        if (!opened)
+            return EMI_SCAN_UNREADABLE;
+        return emis.isEmpty()? EMI_SCAN_NO_EMI: EMI_SCAN_OK;
+    }
+} EMIScanResult;
+
+//! parses many dumps on the EMIScanPipeline stages, results are handed back in input order.
+class EMIBatchScanner
+{
+public:
+    EMIBatchScanner(int jobs = 0); //!0 => QThread::idealThreadCount()
+    ~EMIBatchScanner(){};
+
+    //!directories => all files below it, globs => matching files (sorted).
+    static QStringList ExpandInputs(const QStringList &inputs);
+    void Scan(const QStringList &files, const std::function<void(const EMIScanResult &)> &on_result);
+
+    //!one input with this scanner's sink, cache and io settings, result.output is
+    //!filled when a writer is set. thread safe, the batch workers and the daemon share it.
+    void ScanFile(const qstr &path, EMIScanResult &result) const;
+    QIODevice *OpenInput(const qstr &path, EMIScanResult &result) const; //!nullptr => result.messages says why
+    void ScanDevice(QIODevice &emi_dev, EMIScanResult &result) const; //!result.path is left to the caller
+
+    int jobs() const { return m_jobs; }
+    void setBlobSink(EMIBlobSink *sink) { m_sink = sink; }
+    void setCache(EMIResultCache *cache) { m_cache = cache; }
+    void setDirectIO(bool direct_io) { m_direct_io = direct_io; } //!O_DIRECT for regular files too
+    void setWriter(const EMIWriter *writer) { m_writer = writer; }
+    const EMIWriter *writer() const { return m_writer; }
+    EMIBlobSink *blobSink() const { return m_sink; }
+    EMIResultCache *cache() const { return m_cache; }
+    const EMIPipelineStats &stats() const { return m_stats; } //!of the last Scan()
+private:
+    int m_jobs{1};
+    EMIBlobSink *m_sink{nullptr};
+    EMIResultCache *m_cache{nullptr};
+    bool m_direct_io{0};
+    const EMIWriter *m_writer{nullptr};
+    EMIPipelineStats m_stats{};
+};
+
+#endif // EMI_BATCH_H
@@ -0,0 +1,146 @@
+#include "emi_blockdev.h"
+
+#ifdef Q_OS_LINUX
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <linux/fs.h>
+#endif
+
+EMIBlockDevice::EMIBlockDevice(const qstr &path, QObject *parent) : QIODevice(parent), m_path(path)
+{
+}
+
+EMIBlockDevice::~EMIBlockDevice()
+{
+    close();
+}
+
+bool EMIBlockDevice::IsBlockDevice(const qstr &path)
+{
+#ifdef Q_OS_LINUX
+    struct stat st = {};
+    return !stat(QFile::encodeName(path).constData(), &st) && S_ISBLK(st.st_mode);
+#else
+    Q_UNUSED(path);
+    return 0;
+#endif
+}
+
+bool EMIBlockDevice::open(OpenMode mode)
+{
+#ifdef Q_OS_LINUX
+    if (isOpen() || (mode & WriteOnly))
+    {
+        setErrorString("read only");
+        return 0;
+    }
+
+    qbyte path = QFile::encodeName(m_path);
+    m_fd = ::open(path.constData(), O_RDONLY | O_DIRECT | O_CLOEXEC);
+    m_direct = (m_fd != -1);
+    if (m_fd == -1 && errno == EINVAL) //!tmpfs & co. => buffered reads, dropped from the cache behind us.
+    {
+        m_fd = ::open(path.constData(), O_RDONLY | O_CLOEXEC);
+        if (m_fd != -1)
+            posix_fadvise(m_fd, 0, 0, POSIX_FADV_NOREUSE);
+    }
+
+    if (m_fd == -1)
+    {
+        setErrorString(qt_error_string(errno));
+        return 0;
+    }
+
+    struct stat st = {};
+    fstat(m_fd, &st);
+    if (S_ISBLK(st.st_mode))
+    {
+        quint64 dev_size = 0;
+        int logical_block = 0;
+        if (!ioctl(m_fd, BLKGETSIZE64, &dev_size))
+            m_size = dev_size;
+        if (!ioctl(m_fd, BLKSSZGET, &logical_block) && logical_block > 0)
+            m_block = logical_block;
+    }
+    else
+    {
+        m_size = st.st_size;
+        m_block = 0x1000; //!safe for any filesystem O_DIRECT alignment.
+    }
+
+    void *bounce = nullptr;
+    if (posix_memalign(&bounce, qMax<quint>(m_block, 0x1000), EMI_DIRECT_BOUNCE))
+    {
+        setErrorString("out of memory");
+        ::close(m_fd);
+        m_fd = -1;
+        return 0;
+    }
+    m_bounce = (char*)bounce;
+
+    return QIODevice::open(mode | Unbuffered);
+#else
+    Q_UNUSED(mode);
+    setErrorString("block device input is linux only");
+    return 0;
+#endif
+}
+
+void EMIBlockDevice::close()
+{
+#ifdef Q_OS_LINUX
+    if (m_fd != -1)
+        ::close(m_fd);
+#endif
+    m_fd = -1;
+    free(m_bounce);
+    m_bounce = nullptr;
+    m_size = 0;
+    QIODevice::close();
+}
+
+qint64 EMIBlockDevice::readData(char *data, qint64 maxlen)
+{
+#ifdef Q_OS_LINUX
+    qint64 pos = this->pos();
+    maxlen = qMin(maxlen, m_size - pos);
+
+    qint64 done = 0;
+    while (done < maxlen)
+    {
+        //!O_DIRECT wants block aligned offsets, lengths and buffers.
+        qint64 off = pos + done;
+        qint64 aligned_off = off & ~(qint64)(m_block - 1);
+        qint64 skip = off - aligned_off;
+        qint64 want = (skip + (maxlen - done) + m_block - 1) & ~(qint64)(m_block - 1);
+        want = qMin<qint64>(want, EMI_DIRECT_BOUNCE);
+
+        ssize_t got = pread(m_fd, m_bounce, want, aligned_off);
+        if (got < 0 && errno == EINTR)
+            continue;
+        if (got < 0)
+        {
+            setErrorString(qt_error_string(errno));
+            return done? done: -1;
+        }
+        if (!m_direct && got > 0)
+            posix_fadvise(m_fd, aligned_off, got, POSIX_FADV_DONTNEED);
+        if (got <= skip)
+            break;
+
+        qint64 copy = qMin<qint64>(got - skip, maxlen - done);
+        memcpy(data + done, m_bounce + skip, copy);
+        done += copy;
+
+        if (got < want)
+            break;
+    }
+    return done;
+#else
+    Q_UNUSED(data);
+    Q_UNUSED(maxlen);
+    return -1;
+#endif
+}
@@ -0,0 +1,43 @@
+#ifndef EMI_BLOCKDEV_H
+#define EMI_BLOCKDEV_H
+
+#include "emi_structures.h"
+
+#define EMI_DIRECT_BOUNCE 0x100000 //!1M, largest single O_DIRECT read
+
+//! unbuffered reader for /dev/mmcblk0boot0, UFS LUNs behind a usb bridge, loop devices
+//! or plain files. the size comes from BLKGETSIZE64 (QFile reports 0 for block devices),
+//! reads are widened to whole logical blocks and go through an aligned bounce buffer
+//! with O_DIRECT, so only the header and preloader span EMIImage asks for are read and
+//! the page cache is left alone. linux only, open() fails elsewhere.
+class EMIBlockDevice : public QIODevice
+{
+public:
+    EMIBlockDevice(const qstr &path, QObject *parent = nullptr);
+    ~EMIBlockDevice() override;
+
+    bool open(OpenMode mode) override; //!ReadOnly only
+    void close() override;
+    bool isSequential() const override { return 0; }
+    qint64 size() const override { return m_size; }
+
+    qstr fileName() const { return m_path; }
+    quint blockSize() const { return m_block; }
+    bool isDirect() const { return m_direct; } //!0 => the filesystem refused O_DIRECT, reads go through the page cache
+
+    static bool IsBlockDevice(const qstr &path);
+protected:
+    qint64 readData(char *data, qint64 maxlen) override;
+    qint64 writeData(const char *, qint64) override { return -1; }
+private:
+    Q_DISABLE_COPY(EMIBlockDevice)
+
+    qstr m_path{};
+    int m_fd{-1};
+    qint64 m_size{0};
+    quint m_block{0x1000};
+    bool m_direct{0};
+    char *m_bounce{nullptr};
+};
+
+#endif // EMI_BLOCKDEV_H
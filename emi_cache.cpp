@@ -0,0 +1,283 @@
+#include "emi_cache.h"
+
+#ifdef Q_OS_UNIX
+#include <sys/file.h>
+#endif
+
+#define EMI_CACHE_MAGIC "EMICACHE"
+#define EMI_CACHE_VERSION 3 //!bump whenever Decode() fills the records differently
+#define EMI_CACHE_MIN_HEAP 0x10000 //!64K of records before the first grow
+
+typedef struct EMICacheHeader
+{
+    char magic[8];
+    quint version;
+    quint rec_size; //!sizeof(MTKEMIInfo), a layout change drops the cache
+    quint slots; //!power of two
+    quint used;
+    quint heap_len; //!record bytes in use
+    quint heap_cap;
+} EMICacheHeader;
+
+typedef struct EMICacheSlot
+{
+    qlong key; //!xxh64 of the blob, 0 = empty
+    quint blob_len;
+    quint rec_off;
+    quint rec_count;
+    quint reserved;
+} EMICacheSlot;
+
+static inline EMICacheHeader *cache_header(uchar *map)
+{
+    return (EMICacheHeader*)map;
+}
+
+static inline EMICacheSlot *cache_slots(uchar *map)
+{
+    return (EMICacheSlot*)(map + sizeof(EMICacheHeader));
+}
+
+static inline qint64 cache_heap_off(quint slots)
+{
+    return sizeof(EMICacheHeader) + (qint64)slots * sizeof(EMICacheSlot);
+}
+
+static bool cache_header_valid(const EMICacheHeader &hdr, qint64 file_size)
+{
+    return !memcmp(hdr.magic, EMI_CACHE_MAGIC, sizeof(hdr.magic))
+            && hdr.version == EMI_CACHE_VERSION
+            && hdr.rec_size == sizeof(mtkPreloader::MTKEMIInfo)
+            && hdr.slots && !(hdr.slots & (hdr.slots - 1))
+            && hdr.used < hdr.slots
+            && hdr.heap_len <= hdr.heap_cap
+            && file_size == cache_heap_off(hdr.slots) + hdr.heap_cap;
+}
+
+//! advisory lock on the whole cache file, held across every access: other processes on
+//! the same --cache file grow and rehash it in place. threads of one process share the
+//! open file and are serialized by m_lock on top of it.
+class EMICacheFileLock
+{
+public:
+    EMICacheFileLock(QFile &file, bool exclusive) : m_fd(file.handle())
+    {
+#ifdef Q_OS_UNIX
+        while (m_fd != -1 && flock(m_fd, exclusive? LOCK_EX: LOCK_SH) && errno == EINTR);
+#else
+        Q_UNUSED(exclusive); //!a mapped file can't be resized under another process there.
+#endif
+    }
+    ~EMICacheFileLock()
+    {
+#ifdef Q_OS_UNIX
+        if (m_fd != -1)
+            flock(m_fd, LOCK_UN);
+#endif
+    }
+private:
+    int m_fd;
+};
+
+EMIResultCache::EMIResultCache(const qstr &path, quint slots)
+{
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadWrite))
+        return;
+
+    EMICacheFileLock file_lock(m_file, 1);
+    EMICacheHeader hdr = {};
+    bool valid = m_file.size() >= (qint64)sizeof(hdr)
+            && m_file.read((char*)&hdr, sizeof(hdr)) == sizeof(hdr)
+            && cache_header_valid(hdr, m_file.size());
+
+    if (valid)
+    {
+        map_file(m_file.size());
+        return;
+    }
+
+    //!new, foreign or damaged file => start over.
+    quint pow2 = 0x10;
+    while (pow2 < slots)
+        pow2 <<= 1;
+    init_file(pow2, qbyte());
+}
+
+EMIResultCache::~EMIResultCache()
+{
+    if (m_map)
+        m_file.unmap(m_map);
+    m_file.close();
+}
+
+bool EMIResultCache::map_file(qint64 size)
+{
+    if (m_map)
+        m_file.unmap(m_map);
+    m_map = nullptr;
+    m_map_len = 0;
+
+    if (m_file.size() != size && !m_file.resize(size))
+        return 0;
+
+    m_map = m_file.map(0x00, size);
+    if (!m_map)
+        return 0;
+
+    m_map_len = size;
+    return 1;
+}
+
+bool EMIResultCache::init_file(quint slots, const qbyte &heap)
+{
+    quint heap_cap = EMI_CACHE_MIN_HEAP;
+    while (heap_cap < (quint)heap.size() * 2)
+        heap_cap <<= 1;
+
+    if (!map_file(cache_heap_off(slots) + heap_cap))
+        return 0;
+
+    EMICacheHeader *hdr = cache_header(m_map);
+    memset(m_map, 0x00, cache_heap_off(slots));
+    memcpy(hdr->magic, EMI_CACHE_MAGIC, sizeof(hdr->magic));
+    hdr->version = EMI_CACHE_VERSION;
+    hdr->rec_size = sizeof(mtkPreloader::MTKEMIInfo);
+    hdr->slots = slots;
+    hdr->heap_len = heap.size();
+    hdr->heap_cap = heap_cap;
+    memcpy(m_map + cache_heap_off(slots), heap.constData(), heap.size());
+    return 1;
+}
+
+bool EMIResultCache::grow_slots()
+{
+    //!the heap keeps its relative offsets, only the slots are rehashed.
+    EMICacheHeader *hdr = cache_header(m_map);
+    QVector<EMICacheSlot> used = {};
+    for (quint idx = 0; idx < hdr->slots; idx++)
+    {
+        if (cache_slots(m_map)[idx].key)
+            used.push_back(cache_slots(m_map)[idx]);
+    }
+    quint slots = hdr->slots << 1;
+    qbyte heap((const char*)m_map + cache_heap_off(hdr->slots), hdr->heap_len);
+
+    if (!init_file(slots, heap))
+        return 0;
+
+    for (const EMICacheSlot &slot : used)
+        cache_slots(m_map)[find_slot(slot.key)] = slot;
+    cache_header(m_map)->used = used.size();
+    return 1;
+}
+
+bool EMIResultCache::sync_map()
+{
+    //!another process may have grown the file, or started it over, since it was mapped.
+    qint64 size = m_file.size();
+    if (size != m_map_len && (size < (qint64)sizeof(EMICacheHeader) || !map_file(size)))
+    {
+        if (m_map)
+            m_file.unmap(m_map);
+        m_map = nullptr;
+        m_map_len = 0;
+        return 0;
+    }
+    return m_map && cache_header_valid(*cache_header(m_map), m_map_len);
+}
+
+qsizetype EMIResultCache::find_slot(qlong key) const
+{
+    //!load factor stays below 3/4, there is always an empty slot to stop at.
+    quint mask = cache_header(m_map)->slots - 1;
+    const EMICacheSlot *slots = cache_slots(m_map);
+    for (quint idx = (quint)(key ^ (key >> 32)) & mask;; idx = (idx + 1) & mask)
+    {
+        if (slots[idx].key == key || !slots[idx].key)
+            return idx;
+    }
+}
+
+bool EMIResultCache::Lookup(qlong key, quint blob_len, QVector<mtkPreloader::MTKEMIInfo> &emis)
+{
+    key = key? key: 1;
+
+    QMutexLocker locker(&m_lock);
+    EMICacheFileLock file_lock(m_file, 0);
+    if (!sync_map())
+    {
+        m_misses.fetchAndAddRelaxed(1);
+        return 0;
+    }
+
+    const EMICacheHeader *hdr = cache_header(m_map);
+    const EMICacheSlot &slot = cache_slots(m_map)[find_slot(key)];
+    qint64 rec_len = (qint64)slot.rec_count * sizeof(mtkPreloader::MTKEMIInfo);
+    if (slot.key != key || slot.blob_len != blob_len
+            || slot.rec_off + rec_len > hdr->heap_len)
+    {
+        m_misses.fetchAndAddRelaxed(1);
+        return 0;
+    }
+
+    qsizetype first = emis.size();
+    emis.resize(first + slot.rec_count);
+    memcpy(emis.data() + first, m_map + cache_heap_off(hdr->slots) + slot.rec_off, rec_len);
+    m_hits.fetchAndAddRelaxed(1);
+    return 1;
+}
+
+void EMIResultCache::Insert(qlong key, quint blob_len, const mtkPreloader::MTKEMIInfo *emis, int count)
+{
+    key = key? key: 1;
+
+    QMutexLocker locker(&m_lock);
+    EMICacheFileLock file_lock(m_file, 1);
+    if (!sync_map())
+        return;
+
+    if ((cache_header(m_map)->used + 1) * 4 > cache_header(m_map)->slots * 3 && !grow_slots())
+        return;
+
+    if (cache_slots(m_map)[find_slot(key)].key == key) //!another thread or process was first.
+        return;
+
+    quint rec_len = count * sizeof(mtkPreloader::MTKEMIInfo);
+    EMICacheHeader *hdr = cache_header(m_map);
+    if (hdr->heap_len + rec_len > hdr->heap_cap)
+    {
+        quint slots = hdr->slots;
+        quint heap_cap = hdr->heap_cap;
+        while (heap_cap < hdr->heap_len + rec_len)
+            heap_cap <<= 1;
+
+        if (!map_file(cache_heap_off(slots) + heap_cap))
+            return;
+        hdr = cache_header(m_map);
+        hdr->heap_cap = heap_cap;
+    }
+
+    memcpy(m_map + cache_heap_off(hdr->slots) + hdr->heap_len, emis, rec_len);
+
+    EMICacheSlot &slot = cache_slots(m_map)[find_slot(key)];
+    slot.key = key;
+    slot.blob_len = blob_len;
+    slot.rec_off = hdr->heap_len;
+    slot.rec_count = count;
+    hdr->heap_len += rec_len;
+    hdr->used++;
+}
+
+double EMIResultCache::hitRate() const
+{
+    int total = hits() + misses();
+    return total? (double)hits() / total: 0.0;
+}
+
+quint EMIResultCache::entries()
+{
+    QMutexLocker locker(&m_lock);
+    EMICacheFileLock file_lock(m_file, 0);
+    return sync_map()? cache_header(m_map)->used: 0;
+}
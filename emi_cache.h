@@ -0,0 +1,50 @@
+#ifndef EMI_CACHE_H
+#define EMI_CACHE_H
+
+#include "emi_hash.h"
+
+//! persistent MTK_BLOADER_INFO => decoded records cache.
+//! the file is an open addressed hash table keyed on the blob xxh64, memory mapped and
+//! shared by every parser thread, a hit skips the record decode. processes sharing one
+//! file (--serve next to batch runs) take a flock around each access and remap after
+//! another one grew it.
+//!
+//! layout (little endian, native MTKEMIInfo):
+//!   EMICacheHeader
+//!   EMICacheSlot[slots]     key 0 = empty, linear probing
+//!   MTKEMIInfo[]            record heap, EMICacheSlot::rec_off is relative to it
+class EMIResultCache
+{
+public:
+    EMIResultCache(const qstr &path, quint slots = 0x1000);
+    ~EMIResultCache();
+
+    bool isOpen() const { return m_map != nullptr; }
+    qstr errorString() const { return m_file.errorString(); }
+
+    //!appends the cached records of the blob to emis, counts a hit or a miss.
+    bool Lookup(qlong key, quint blob_len, QVector<mtkPreloader::MTKEMIInfo> &emis);
+    void Insert(qlong key, quint blob_len, const mtkPreloader::MTKEMIInfo *emis, int count);
+
+    int hits() const { return m_hits.loadAcquire(); }
+    int misses() const { return m_misses.loadAcquire(); }
+    double hitRate() const;
+    quint entries();
+private:
+    Q_DISABLE_COPY(EMIResultCache)
+
+    bool map_file(qint64 size);
+    bool init_file(quint slots, const qbyte &heap);
+    bool grow_slots();
+    bool sync_map(); //!file lock held, 0 => unusable right now
+    qsizetype find_slot(qlong key) const;
+
+    QFile m_file{};
+    uchar *m_map{nullptr}; //!guarded by m_lock
+    qint64 m_map_len{0};
+    mutable QMutex m_lock{};
+    QAtomicInt m_hits{0};
+    QAtomicInt m_misses{0};
+};
+
+#endif // EMI_CACHE_H
@@ -0,0 +1,339 @@
+#include "emi_daemon.h"
+#include "emi_writer.h"
+
+#ifdef Q_OS_UNIX
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#ifndef MSG_NOSIGNAL //!a client that hangs up must not SIGPIPE the daemon.
+#define MSG_NOSIGNAL 0
+#endif
+#ifndef MSG_CMSG_CLOEXEC
+#define MSG_CMSG_CLOEXEC 0
+#endif
+#endif
+
+//!one accepted connection, lives until the reader and all its queued requests are done.
+typedef struct EMIDaemonClient
+{
+    int fd{-1};
+    QMutex write_lock{}; //!responses of one client come from several workers
+    ~EMIDaemonClient()
+    {
+#ifdef Q_OS_UNIX
+        if (fd != -1)
+            ::close(fd);
+#endif
+    }
+} EMIDaemonClient;
+
+#ifdef Q_OS_UNIX
+//!reads exactly len bytes, picks up an fd passed along with them.
+static bool recv_exact(int fd, char *data, qsizetype len, int &passed_fd)
+{
+    qsizetype done = 0;
+    while (done < len)
+    {
+        union
+        {
+            char buf[CMSG_SPACE(sizeof(int))];
+            struct cmsghdr align;
+        } control;
+        struct iovec iov = {data + done, (size_t)(len - done)};
+        struct msghdr msg = {};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control.buf;
+        msg.msg_controllen = sizeof(control.buf);
+
+        ssize_t got = recvmsg(fd, &msg, MSG_CMSG_CLOEXEC);
+        if (got < 0 && errno == EINTR)
+            continue;
+        if (got <= 0)
+            return 0;
+
+        for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg))
+        {
+            if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS)
+                continue;
+
+            int count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            for (int idx = 0; idx < count; idx++)
+            {
+                int fd_in = -1;
+                memcpy(&fd_in, CMSG_DATA(cmsg) + idx * sizeof(int), sizeof(int));
+                if (passed_fd == -1) //!one fd per request, extra ones are closed.
+                    passed_fd = fd_in;
+                else
+                    ::close(fd_in);
+            }
+        }
+        done += got;
+    }
+    return 1;
+}
+
+static bool send_all(int fd, const char *data, qsizetype len)
+{
+    while (len > 0)
+    {
+        ssize_t sent = send(fd, data, len, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR)
+            continue;
+        if (sent <= 0)
+            return 0;
+        data += sent;
+        len -= sent;
+    }
+    return 1;
+}
+#endif
+
+static void send_response(EMIDaemonClient &client, quint id, quint8 status, const qbyte &payload)
+{
+    qbyte frame(EMI_DAEMON_HDR_LEN, Qt::Uninitialized);
+    qToLittleEndian<quint>(payload.size() + 5, frame.data());
+    qToLittleEndian<quint>(id, frame.data() + 4);
+    frame[8] = (char)status;
+    frame.append(payload);
+
+#ifdef Q_OS_UNIX
+    QMutexLocker locker(&client.write_lock);
+    send_all(client.fd, frame.constData(), frame.size()); //!a gone client is noticed by its reader.
+#else
+    Q_UNUSED(client);
+#endif
+}
+
+class EMIDaemonTask : public QRunnable
+{
+public:
+    EMIDaemonTask(EMIDaemon &daemon, const QSharedPointer<EMIDaemonClient> &client,
+                  quint id, quint8 kind, const qbyte &payload, int fd) :
+        m_daemon(daemon), m_client(client), m_id(id), m_kind(kind), m_payload(payload), m_fd(fd) {}
+
+    void run() override
+    {
+        EMIScanResult result = {};
+        result.path = QFile::decodeName(m_payload);
+
+        if (m_kind == EMI_REQ_PATH && m_fd == -1)
+        {
+            m_daemon.m_scanner.ScanFile(result.path, result);
+        }
+        else if (m_kind == EMI_REQ_FD && m_fd != -1)
+        {
+            QFile emi_dev;
+            if (emi_dev.open(m_fd, QIODevice::ReadOnly, QFileDevice::AutoCloseHandle))
+            {
+                m_fd = -1;
+                m_daemon.m_scanner.ScanDevice(emi_dev, result);
+            }
+            else
+            {
+                result.messages << qstr("unable to open fd{%0}:%1").arg(result.path, emi_dev.errorString());
+            }
+        }
+        else
+        {
+            result.messages << qstr("invalid request{%0}").arg(m_kind);
+        }
+
+#ifdef Q_OS_UNIX
+        if (m_fd != -1)
+            ::close(m_fd);
+#endif
+        if (result.output.isEmpty() && m_daemon.m_scanner.writer())
+            m_daemon.m_scanner.writer()->Format(result, result.output);
+
+        send_response(*m_client, m_id, result.status(), result.output);
+        m_daemon.m_served.fetchAndAddRelaxed(1);
+        m_daemon.m_slots.release();
+    }
+private:
+    EMIDaemon &m_daemon;
+    QSharedPointer<EMIDaemonClient> m_client;
+    quint m_id{0};
+    quint8 m_kind{0};
+    qbyte m_payload{};
+    int m_fd{-1};
+};
+
+class EMIDaemonConnection : public QRunnable
+{
+public:
+    EMIDaemonConnection(EMIDaemon &daemon, const QSharedPointer<EMIDaemonClient> &client) :
+        m_daemon(daemon), m_client(client) {}
+
+    void run() override
+    {
+#ifdef Q_OS_UNIX
+        if (m_daemon.m_scanner.writer())
+            send_response(*m_client, 0, EMI_SCAN_OK, m_daemon.m_scanner.writer()->Header());
+
+        forever
+        {
+            char hdr[EMI_DAEMON_HDR_LEN];
+            int passed_fd = -1;
+            if (!recv_exact(m_client->fd, hdr, sizeof(hdr), passed_fd))
+                break;
+
+            quint len = qFromLittleEndian<quint>(hdr);
+            quint id = qFromLittleEndian<quint>(hdr + 4);
+            quint8 kind = (quint8)hdr[8];
+
+            qbyte payload;
+            if (len >= 5 && len <= EMI_DAEMON_MAX_FRAME)
+            {
+                payload.resize(len - 5);
+                if (!recv_exact(m_client->fd, payload.data(), payload.size(), passed_fd))
+                    len = 0;
+            }
+            if (len < 5 || len > EMI_DAEMON_MAX_FRAME) //!out of sync, drop the connection.
+            {
+                if (passed_fd != -1)
+                    ::close(passed_fd);
+                break;
+            }
+
+            //!backpressure: wait for a free queue entry before reading the next frame.
+            m_daemon.m_slots.acquire();
+            m_daemon.m_workers.start(new EMIDaemonTask(m_daemon, m_client, id, kind, payload, passed_fd));
+        }
+#endif
+        m_daemon.drop_client(m_client->fd);
+    }
+private:
+    EMIDaemon &m_daemon;
+    QSharedPointer<EMIDaemonClient> m_client;
+};
+
+EMIDaemon::EMIDaemon(const EMIBatchScanner &scanner, int queue_depth) :
+    m_scanner(scanner), m_slots(queue_depth > 0? queue_depth: scanner.jobs() * 4)
+{
+    m_workers.setMaxThreadCount(scanner.jobs());
+    m_connections.setMaxThreadCount(EMI_DAEMON_MAX_CLIENTS);
+}
+
+EMIDaemon::~EMIDaemon()
+{
+#ifdef Q_OS_UNIX
+    if (m_listen_fd != -1)
+    {
+        ::close(m_listen_fd);
+        ::unlink(m_socket_path.constData());
+    }
+#endif
+}
+
+bool EMIDaemon::Listen(const qstr &socket_path)
+{
+#ifdef Q_OS_UNIX
+    qbyte path = QFile::encodeName(socket_path);
+    struct sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    if (path.isEmpty() || path.size() >= (qsizetype)sizeof(addr.sun_path))
+    {
+        m_error = qstr("invalid socket path{%0}").arg(socket_path);
+        return 0;
+    }
+    memcpy(addr.sun_path, path.constData(), path.size());
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd == -1)
+    {
+        m_error = qt_error_string(errno);
+        return 0;
+    }
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+    //!a socket file nobody answers on is left over from a killed daemon. connect() is
+    //!refused on any other kind of file too, that one is never removed.
+    struct stat st = {};
+    if (!lstat(path.constData(), &st) && !S_ISSOCK(st.st_mode))
+    {
+        ::close(fd);
+        m_error = qstr("not a socket{%0}").arg(socket_path);
+        return 0;
+    }
+    if (!::connect(fd, (struct sockaddr*)&addr, sizeof(addr)))
+    {
+        ::close(fd);
+        m_error = qstr("another daemon is serving{%0}").arg(socket_path);
+        return 0;
+    }
+    if (errno == ECONNREFUSED)
+        ::unlink(path.constData());
+
+    ::close(fd);
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd == -1 || bind(fd, (struct sockaddr*)&addr, sizeof(addr)) || listen(fd, EMI_DAEMON_MAX_CLIENTS))
+    {
+        m_error = qt_error_string(errno);
+        if (fd != -1)
+            ::close(fd);
+        return 0;
+    }
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+    m_listen_fd = fd;
+    m_socket_path = path;
+    return 1;
+#else
+    m_error = qstr("unix domain sockets are not supported here{%0}").arg(socket_path);
+    return 0;
+#endif
+}
+
+void EMIDaemon::Serve()
+{
+#ifdef Q_OS_UNIX
+    while (m_listen_fd != -1 && !m_stop.loadAcquire())
+    {
+        //!poll with a timeout, Stop() from a signal handler only sets the flag.
+        struct pollfd pfd = {m_listen_fd, POLLIN, 0};
+        if (poll(&pfd, 1, 200) <= 0)
+            continue;
+
+        int fd = accept(m_listen_fd, nullptr, nullptr);
+        if (fd == -1)
+            continue;
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+        QSharedPointer<EMIDaemonClient> client(new EMIDaemonClient);
+        client->fd = fd;
+        bool busy = 0;
+        {
+            QMutexLocker locker(&m_lock);
+            busy = m_clients.size() >= EMI_DAEMON_MAX_CLIENTS;
+            if (!busy)
+                m_clients.insert(fd);
+        }
+        if (busy) //!past the cap a client would wait in the pool queue unanswered, it is told and closed.
+        {
+            send_response(*client, 0, EMI_DAEMON_BUSY, qstr("too many clients{%0}").arg(EMI_DAEMON_MAX_CLIENTS).toUtf8());
+            continue;
+        }
+        m_connections.start(new EMIDaemonConnection(*this, client));
+    }
+
+    //!wake the readers, the queued requests are still answered.
+    {
+        QMutexLocker locker(&m_lock);
+        for (int fd : m_clients)
+            shutdown(fd, SHUT_RD);
+    }
+    m_connections.waitForDone();
+    m_workers.waitForDone();
+#endif
+}
+
+void EMIDaemon::drop_client(int fd)
+{
+    QMutexLocker locker(&m_lock);
+    m_clients.remove(fd);
+}
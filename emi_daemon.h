@@ -0,0 +1,62 @@
+#ifndef EMI_DAEMON_H
+#define EMI_DAEMON_H
+
+#include "emi_batch.h"
+
+#define EMI_DAEMON_HDR_LEN 9 //!u32:len u32:id u8:kind/status
+#define EMI_DAEMON_MAX_FRAME 0x10000 //!requests only carry a path
+#define EMI_DAEMON_MAX_CLIENTS 0x40
+#define EMI_DAEMON_BUSY 0xff //!status of the id 0 frame a client past EMI_DAEMON_MAX_CLIENTS gets
+
+//! request kinds.
+enum EMIDaemonRequest
+{
+    EMI_REQ_PATH = 1, //!payload = utf-8 path the daemon opens itself
+    EMI_REQ_FD = 2, //!one open fd as SCM_RIGHTS with the frame, payload = name to report
+};
+
+//! resident parser on a unix domain socket, flashing stations query it instead of
+//! starting a process per dump. every frame is little endian:
+//!   request  : u32:len u32:id u8:kind   payload[len - 5]
+//!   response : u32:len u32:id u8:status payload[len - 5] = writer output of the input
+//! status is an EMIScanStatus. right after accept the daemon sends one response with
+//! id 0 holding the writer Header() (empty for text and jsonl). with EMI_DAEMON_MAX_CLIENTS
+//! connected, a new client gets an EMI_DAEMON_BUSY frame with id 0 instead and is closed.
+//! clients may pipeline, responses carry the request id and can come back out of order.
+//! requests are parsed on a pool of scanner.jobs() threads; once queue_depth of them are
+//! parsing or waiting no connection is read any further, the kernel socket buffers fill
+//! and the clients block in send(). a pipelining client has to keep reading responses
+//! while it sends, or both ends end up waiting on full buffers. unix only, Listen() fails elsewhere.
+class EMIDaemon
+{
+public:
+    EMIDaemon(const EMIBatchScanner &scanner, int queue_depth = 0); //!0 => 4 per job
+    ~EMIDaemon();
+
+    bool Listen(const qstr &socket_path); //!replaces a stale socket, not a live daemon or other file
+    void Serve(); //!until Stop(), then answers what was already queued
+    void Stop() { m_stop.storeRelease(1); } //!async signal safe
+
+    qstr errorString() const { return m_error; }
+    int served() const { return m_served.loadAcquire(); }
+private:
+    Q_DISABLE_COPY(EMIDaemon)
+    friend class EMIDaemonConnection;
+    friend class EMIDaemonTask;
+
+    void drop_client(int fd);
+
+    const EMIBatchScanner &m_scanner;
+    QThreadPool m_workers{};
+    QThreadPool m_connections{};
+    QSemaphore m_slots; //!free queue entries
+    QSet<int> m_clients{}; //!guarded by m_lock, woken on Stop()
+    QMutex m_lock{};
+    QAtomicInt m_stop{0};
+    QAtomicInt m_served{0};
+    int m_listen_fd{-1};
+    qbyte m_socket_path{};
+    qstr m_error{};
+};
+
+#endif // EMI_DAEMON_H
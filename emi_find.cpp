@@ -0,0 +1,168 @@
+#include "emi_find.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define EMI_FIND_X86
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) || (defined(__ARM_NEON) && defined(__GNUC__))
+#define EMI_FIND_NEON
+#include <arm_neon.h>
+#endif
+
+static qsizetype find_scalar(const char *data, qsizetype len, const char *needle, qsizetype needle_len)
+{
+    if (needle_len <= 0 || needle_len > len)
+        return (needle_len == 0)?0: -1;
+
+    const char *pos = data;
+    const char *end = data + len - needle_len + 1;
+    while (pos < end)
+    {
+        pos = (const char*)memchr(pos, needle[0], end - pos);
+        if (!pos)
+            return -1;
+        if (!memcmp(pos + 1, needle + 1, needle_len - 1))
+            return pos - data;
+        pos++;
+    }
+    return -1;
+}
+
+//!candidates = bit i set when data[i] == needle[0] && data[i + needle_len - 1] == needle[last].
+static inline qsizetype check_candidates(const char *data, qsizetype idx, quint mask, const char *needle, qsizetype needle_len)
+{
+    while (mask)
+    {
+        qsizetype pos = idx + qCountTrailingZeroBits(mask);
+        if (!memcmp(data + pos + 1, needle + 1, needle_len - 2))
+            return pos;
+        mask &= mask - 1;
+    }
+    return -1;
+}
+
+static inline qsizetype find_tail(const char *data, qsizetype len, qsizetype idx, const char *needle, qsizetype needle_len)
+{
+    qsizetype pos = find_scalar(data + idx, len - idx, needle, needle_len);
+    return (pos == -1)?-1: idx + pos;
+}
+
+#ifdef EMI_FIND_X86
+__attribute__((target("sse2")))
+static qsizetype find_sse2(const char *data, qsizetype len, const char *needle, qsizetype needle_len)
+{
+    if (needle_len < 2)
+        return find_scalar(data, len, needle, needle_len);
+
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[needle_len - 1]);
+
+    qsizetype idx = 0;
+    for (; idx + needle_len - 1 + 0x10 <= len; idx += 0x10)
+    {
+        __m128i block_first = _mm_loadu_si128((const __m128i*)(data + idx));
+        __m128i block_last = _mm_loadu_si128((const __m128i*)(data + idx + needle_len - 1));
+        quint mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(block_first, first),
+                                                     _mm_cmpeq_epi8(block_last, last)));
+        if (mask)
+        {
+            qsizetype pos = check_candidates(data, idx, mask, needle, needle_len);
+            if (pos != -1)
+                return pos;
+        }
+    }
+
+    return find_tail(data, len, idx, needle, needle_len);
+}
+
+__attribute__((target("avx2")))
+static qsizetype find_avx2(const char *data, qsizetype len, const char *needle, qsizetype needle_len)
+{
+    if (needle_len < 2)
+        return find_scalar(data, len, needle, needle_len);
+
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last = _mm256_set1_epi8(needle[needle_len - 1]);
+
+    qsizetype idx = 0;
+    for (; idx + needle_len - 1 + 0x40 <= len; idx += 0x40) //!2x unrolled, one branch per 64 bytes
+    {
+        const char *block = data + idx;
+        __m256i eq0 = _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)block), first),
+                                       _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(block + needle_len - 1)), last));
+        __m256i eq1 = _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(block + 0x20)), first),
+                                       _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(block + 0x20 + needle_len - 1)), last));
+        if (_mm256_testz_si256(_mm256_or_si256(eq0, eq1), _mm256_set1_epi8(-1)))
+            continue;
+
+        qsizetype pos = check_candidates(data, idx, _mm256_movemask_epi8(eq0), needle, needle_len);
+        if (pos == -1)
+            pos = check_candidates(data, idx + 0x20, _mm256_movemask_epi8(eq1), needle, needle_len);
+        if (pos != -1)
+            return pos;
+    }
+
+    return find_tail(data, len, idx, needle, needle_len);
+}
+#endif
+
+#ifdef EMI_FIND_NEON
+static qsizetype find_neon(const char *data, qsizetype len, const char *needle, qsizetype needle_len)
+{
+    if (needle_len < 2)
+        return find_scalar(data, len, needle, needle_len);
+
+    const uint8x16_t first = vdupq_n_u8(needle[0]);
+    const uint8x16_t last = vdupq_n_u8(needle[needle_len - 1]);
+
+    qsizetype idx = 0;
+    for (; idx + needle_len - 1 + 0x10 <= len; idx += 0x10)
+    {
+        uint8x16_t block_first = vld1q_u8((const uint8_t*)(data + idx));
+        uint8x16_t block_last = vld1q_u8((const uint8_t*)(data + idx + needle_len - 1));
+        uint8x16_t eq = vandq_u8(vceqq_u8(block_first, first), vceqq_u8(block_last, last));
+
+        //!no movemask on neon: narrow to 4 bits per byte.
+        qlong nibbles = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+        while (nibbles)
+        {
+            qsizetype pos = idx + (qCountTrailingZeroBits(nibbles) >> 2);
+            if (!memcmp(data + pos + 1, needle + 1, needle_len - 2))
+                return pos;
+            nibbles &= ~(0xfULL << ((pos - idx) << 2));
+        }
+    }
+
+    return find_tail(data, len, idx, needle, needle_len);
+}
+#endif
+
+static QVector<EMIFindKernel> find_kernels()
+{
+    QVector<EMIFindKernel> kernels = {};
+#ifdef EMI_FIND_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        kernels.push_back({"avx2", find_avx2});
+    if (__builtin_cpu_supports("sse2"))
+        kernels.push_back({"sse2", find_sse2});
+#endif
+#ifdef EMI_FIND_NEON
+    kernels.push_back({"neon", find_neon});
+#endif
+    kernels.push_back({"scalar", find_scalar});
+    return kernels;
+}
+
+const QVector<EMIFindKernel> &EMIFindKernels()
+{
+    static const QVector<EMIFindKernel> kernels = find_kernels();
+    return kernels;
+}
+
+qsizetype EMIFind(const char *data, qsizetype len, const char *needle, qsizetype needle_len)
+{
+    static const EMIFindFn find = EMIFindKernels().first().find;
+    return find(data, len, needle, needle_len);
+}
@@ -0,0 +1,24 @@
+#ifndef EMI_FIND_H
+#define EMI_FIND_H
+
+#include "emi_structures.h"
+
+//! offset of the first needle in data or -1.
+typedef qsizetype (*EMIFindFn)(const char *data, qsizetype len, const char *needle, qsizetype needle_len);
+
+typedef struct EMIFindKernel
+{
+    const char *name;
+    EMIFindFn find;
+} EMIFindKernel;
+
+//! substring search kernels usable on this cpu, best first (avx2, sse2, neon, scalar).
+//! the vector kernels test the first and last needle byte over 16/32 positions at
+//! once and only memcmp the candidates, long needles like MTK_BLOADER_INFO_v
+//! rarely produce any.
+const QVector<EMIFindKernel> &EMIFindKernels();
+
+//! runtime dispatched to EMIFindKernels().first().
+qsizetype EMIFind(const char *data, qsizetype len, const char *needle, qsizetype needle_len);
+
+#endif // EMI_FIND_H
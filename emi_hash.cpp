@@ -0,0 +1,100 @@
+#include "emi_hash.h"
+
+static const qlong XXH_PRIME64_1 = 0x9e3779b185ebca87ULL;
+static const qlong XXH_PRIME64_2 = 0xc2b2ae3d27d4eb4fULL;
+static const qlong XXH_PRIME64_3 = 0x165667b19e3779f9ULL;
+static const qlong XXH_PRIME64_4 = 0x85ebca77c2b2ae63ULL;
+static const qlong XXH_PRIME64_5 = 0x27d4eb2f165667c5ULL;
+
+static inline qlong xxh_rotl(qlong x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline qlong xxh_read64(const char *p)
+{
+    qlong v = 0;
+    memcpy(&v, p, sizeof(v)); //!little endian hosts only (x86/arm).
+    return v;
+}
+
+static inline quint xxh_read32(const char *p)
+{
+    quint v = 0;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline qlong xxh_round(qlong acc, qlong input)
+{
+    acc += input * XXH_PRIME64_2;
+    acc = xxh_rotl(acc, 31);
+    return acc * XXH_PRIME64_1;
+}
+
+static inline qlong xxh_merge(qlong acc, qlong val)
+{
+    acc ^= xxh_round(0, val);
+    return acc * XXH_PRIME64_1 + XXH_PRIME64_4;
+}
+
+qlong emi_xxh64(const char *data, qsizetype len, qlong seed)
+{
+    const char *p = data;
+    const char *end = data + len;
+    qlong h64 = 0;
+
+    if (len >= 0x20)
+    {
+        qlong v1 = seed + XXH_PRIME64_1 + XXH_PRIME64_2;
+        qlong v2 = seed + XXH_PRIME64_2;
+        qlong v3 = seed;
+        qlong v4 = seed - XXH_PRIME64_1;
+
+        for (; p + 0x20 <= end; p += 0x20)
+        {
+            v1 = xxh_round(v1, xxh_read64(p + 0x00));
+            v2 = xxh_round(v2, xxh_read64(p + 0x08));
+            v3 = xxh_round(v3, xxh_read64(p + 0x10));
+            v4 = xxh_round(v4, xxh_read64(p + 0x18));
+        }
+
+        h64 = xxh_rotl(v1, 1) + xxh_rotl(v2, 7) + xxh_rotl(v3, 12) + xxh_rotl(v4, 18);
+        h64 = xxh_merge(h64, v1);
+        h64 = xxh_merge(h64, v2);
+        h64 = xxh_merge(h64, v3);
+        h64 = xxh_merge(h64, v4);
+    }
+    else
+    {
+        h64 = seed + XXH_PRIME64_5;
+    }
+
+    h64 += (qlong)len;
+
+    for (; p + 8 <= end; p += 8)
+    {
+        h64 ^= xxh_round(0, xxh_read64(p));
+        h64 = xxh_rotl(h64, 27) * XXH_PRIME64_1 + XXH_PRIME64_4;
+    }
+
+    if (p + 4 <= end)
+    {
+        h64 ^= (qlong)xxh_read32(p) * XXH_PRIME64_1;
+        h64 = xxh_rotl(h64, 23) * XXH_PRIME64_2 + XXH_PRIME64_3;
+        p += 4;
+    }
+
+    for (; p < end; p++)
+    {
+        h64 ^= (qlong)(qchar)*p * XXH_PRIME64_5;
+        h64 = xxh_rotl(h64, 11) * XXH_PRIME64_1;
+    }
+
+    h64 ^= h64 >> 33;
+    h64 *= XXH_PRIME64_2;
+    h64 ^= h64 >> 29;
+    h64 *= XXH_PRIME64_3;
+    h64 ^= h64 >> 32;
+    return h64;
+}
@@ -0,0 +1,20 @@
+#ifndef EMI_HASH_H
+#define EMI_HASH_H
+
+#include "emi_structures.h"
+
+//! XXH64 of a buffer, used to content-address emi blobs.
+qlong emi_xxh64(const char *data, qsizetype len, qlong seed = 0);
+
+inline qlong emi_xxh64(const qbyte &data, qlong seed = 0)
+{
+    return emi_xxh64(data.constData(), data.size(), seed);
+}
+
+//! 16 lower-case hex digits, fixed width.
+inline qstr emi_hash_name(qlong hash)
+{
+    return qstr("%0").arg(hash, 0x10, 0x10, QLatin1Char('0'));
+}
+
+#endif // EMI_HASH_H
@@ -0,0 +1,177 @@
+#include "emi_index.h"
+
+#include <algorithm>
+
+#define EMI_INDEX_MAGIC "EMIINDEX"
+#define EMI_INDEX_VERSION 2
+
+typedef struct EMIIndexHeader
+{
+    char magic[8];
+    quint version;
+    quint entry_size; //!sizeof(EMIIndexEntry), a layout change drops the index
+    quint entries;
+    quint strings_len;
+} EMIIndexHeader;
+
+//!flash ids are zero padded, comparing all 16 bytes orders them like their hex strings.
+static inline bool entry_less(const EMIIndexEntry &a, const EMIIndexEntry &b)
+{
+    int cmp = memcmp(a.flash_id, b.flash_id, sizeof(a.flash_id));
+    return cmp? cmp < 0: a.dram_size < b.dram_size;
+}
+
+void EMIIndexBuilder::Add(const EMIScanResult &result)
+{
+    if (result.emis.isEmpty())
+        return;
+
+    quint path_off = add_string(result.path);
+    quint soc_off = add_string(result.header.platform);
+    for (const mtkPreloader::MTKEMIInfo &emi : result.emis)
+    {
+        EMIIndexEntry entry = {};
+        memcpy(entry.flash_id, emi.flash_id, sizeof(entry.flash_id));
+        entry.dram_size = emi.dram_size;
+        entry.path_off = path_off;
+        entry.soc_off = soc_off;
+        entry.dram_type = emi.dram_type;
+        entry.index = emi.index;
+        entry.id_len = emi.id_len;
+        entry.emi_ver = emi.emi_ver;
+        entry.is_ufs = emi.is_ufs;
+        m_entries.push_back(entry);
+    }
+}
+
+quint EMIIndexBuilder::add_string(const qstr &str)
+{
+    if (m_strings.contains(str))
+        return m_strings.value(str);
+
+    quint off = m_pool.size();
+    m_pool.append(str.toUtf8());
+    m_pool.append('\0');
+    m_strings.insert(str, off);
+    return off;
+}
+
+bool EMIIndexBuilder::Write(const qstr &path)
+{
+    //!stable => records of one flash id stay in input order.
+    std::stable_sort(m_entries.begin(), m_entries.end(), entry_less);
+
+    EMIIndexHeader hdr = {};
+    memcpy(hdr.magic, EMI_INDEX_MAGIC, sizeof(hdr.magic));
+    hdr.version = EMI_INDEX_VERSION;
+    hdr.entry_size = sizeof(EMIIndexEntry);
+    hdr.entries = m_entries.size();
+    hdr.strings_len = m_pool.size();
+
+    qint64 entries_len = (qint64)m_entries.size() * sizeof(EMIIndexEntry);
+    QSaveFile index_file(path);
+    if (!index_file.open(QIODevice::WriteOnly)
+            || index_file.write((const char*)&hdr, sizeof(hdr)) != sizeof(hdr)
+            || index_file.write((const char*)m_entries.constData(), entries_len) != entries_len
+            || index_file.write(m_pool) != m_pool.size()
+            || !index_file.commit())
+    {
+        m_error = index_file.errorString();
+        return 0;
+    }
+    return 1;
+}
+
+EMIIndex::EMIIndex(const qstr &path)
+{
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly))
+    {
+        m_error = m_file.errorString();
+        return;
+    }
+
+    EMIIndexHeader hdr = {};
+    bool valid = m_file.size() >= (qint64)sizeof(hdr)
+            && m_file.read((char*)&hdr, sizeof(hdr)) == (qint64)sizeof(hdr)
+            && !memcmp(hdr.magic, EMI_INDEX_MAGIC, sizeof(hdr.magic))
+            && hdr.version == EMI_INDEX_VERSION
+            && hdr.entry_size == sizeof(EMIIndexEntry)
+            && m_file.size() == (qint64)(sizeof(hdr) + (qint64)hdr.entries * sizeof(EMIIndexEntry) + hdr.strings_len);
+    if (!valid)
+    {
+        m_error = qstr("invalid/unsupported index file{%0}").arg(path);
+        return;
+    }
+
+    m_map = m_file.map(0x00, m_file.size());
+    if (!m_map)
+    {
+        m_error = m_file.errorString();
+        return;
+    }
+    m_entries = (const EMIIndexEntry*)(m_map + sizeof(hdr));
+    m_strings = (const char*)(m_entries + hdr.entries);
+
+    //!every string ends inside the pool once the last one does.
+    if (hdr.strings_len && m_strings[hdr.strings_len - 1] != '\0')
+    {
+        m_file.unmap(m_map);
+        m_map = nullptr;
+        m_error = qstr("invalid/unsupported index file{%0}").arg(path);
+    }
+}
+
+EMIIndex::~EMIIndex()
+{
+    if (m_map)
+        m_file.unmap(m_map);
+    m_file.close();
+}
+
+quint EMIIndex::entries() const
+{
+    return m_map? ((const EMIIndexHeader*)m_map)->entries: 0;
+}
+
+const char *EMIIndex::get_string(quint off) const
+{
+    return off < ((const EMIIndexHeader*)m_map)->strings_len? m_strings + off: "";
+}
+
+int EMIIndex::Query(const qbyte &prefix, qlong dram_size, QVector<EMIIndexHit> &hits) const
+{
+    if (!m_map || prefix.size() > (qsizetype)sizeof(EMIIndexEntry::flash_id))
+        return 0;
+
+    //!two binary searches bound the run of entries starting with prefix.
+    const EMIIndexEntry *end = m_entries + entries();
+    const EMIIndexEntry *first = std::lower_bound(m_entries, end, prefix, [](const EMIIndexEntry &entry, const qbyte &key) {
+        return memcmp(entry.flash_id, key.constData(), key.size()) < 0;
+    });
+    const EMIIndexEntry *last = std::upper_bound(first, end, prefix, [](const qbyte &key, const EMIIndexEntry &entry) {
+        return memcmp(key.constData(), entry.flash_id, key.size()) < 0;
+    });
+
+    int found = 0;
+    for (const EMIIndexEntry *entry = first; entry != last; entry++)
+    {
+        //!the padding matches a prefix of zeros too, it isn't part of the id.
+        if (entry->id_len < prefix.size() || (dram_size && entry->dram_size != dram_size))
+            continue;
+
+        EMIIndexHit hit = {};
+        hit.path = qstr::fromUtf8(get_string(entry->path_off));
+        hit.soc = qstr::fromUtf8(get_string(entry->soc_off));
+        memcpy(hit.emi.flash_id, entry->flash_id, sizeof(hit.emi.flash_id));
+        hit.emi.index = entry->index;
+        hit.emi.emi_ver = entry->emi_ver;
+        hit.emi.dram_type = (mtkPreloader::EMIDramType)entry->dram_type;
+        hit.emi.id_len = entry->id_len;
+        hit.emi.is_ufs = entry->is_ufs;
+        hit.emi.dram_size = entry->dram_size;
+        hits.push_back(hit);
+        found++;
+    }
+    return found;
+}
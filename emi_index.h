@@ -0,0 +1,81 @@
+#ifndef EMI_INDEX_H
+#define EMI_INDEX_H
+
+#include "emi_batch.h"
+
+//! one decoded record in the index, sorted on flash_id then dram_size.
+typedef struct EMIIndexEntry
+{
+    qchar flash_id[0x10]; //!zero padded past id_len
+    qlong dram_size; //!bytes, all ranks
+    quint path_off; //!string pool offsets
+    quint soc_off;
+    quint index; //!record number in its blob
+    quint16 dram_type;
+    quint8 id_len;
+    quint8 emi_ver;
+    quint8 is_ufs;
+    quint8 reserved[7];
+} EMIIndexEntry;
+static_assert(sizeof(EMIIndexEntry) == 48, "EMIIndexEntry layout changed, bump EMI_INDEX_VERSION");
+
+typedef struct EMIIndexHit
+{
+    qstr path{};
+    qstr soc{};
+    mtkPreloader::MTKEMIInfo emi{}; //!no blob behind it, cfg_len = 0
+} EMIIndexHit;
+
+//! flash id => preloader inverted index over a dump corpus, built from batch scan results.
+//!
+//! layout (little endian, native EMIIndexEntry):
+//!   EMIIndexHeader
+//!   EMIIndexEntry[entries]  sorted, a flash id prefix is one contiguous run
+//!   char[strings_len]       NUL terminated utf-8 paths and soc names, each stored once
+class EMIIndexBuilder
+{
+public:
+    EMIIndexBuilder(){}
+    ~EMIIndexBuilder(){};
+
+    void Add(const EMIScanResult &result);
+    bool Write(const qstr &path); //!sorts, then replaces the file in one go
+    int entries() const { return m_entries.size(); }
+    qstr errorString() const { return m_error; }
+private:
+    Q_DISABLE_COPY(EMIIndexBuilder)
+
+    quint add_string(const qstr &str);
+
+    QVector<EMIIndexEntry> m_entries{};
+    QHash<qstr, quint> m_strings{};
+    qbyte m_pool{};
+    qstr m_error{};
+};
+
+//! read only view of an index file, memory mapped; queries never touch the dumps.
+class EMIIndex
+{
+public:
+    EMIIndex(const qstr &path);
+    ~EMIIndex();
+
+    bool isOpen() const { return m_map != nullptr; }
+    qstr errorString() const { return m_error; }
+    quint entries() const;
+
+    //!appends the records whose flash_id starts with prefix, dram_size 0 => any size.
+    int Query(const qbyte &prefix, qlong dram_size, QVector<EMIIndexHit> &hits) const;
+private:
+    Q_DISABLE_COPY(EMIIndex)
+
+    const char *get_string(quint off) const;
+
+    QFile m_file{};
+    uchar *m_map{nullptr};
+    const EMIIndexEntry *m_entries{nullptr};
+    const char *m_strings{nullptr};
+    qstr m_error{};
+};
+
+#endif // EMI_INDEX_H
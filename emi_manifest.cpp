@@ -0,0 +1,372 @@
+#include "emi_manifest.h"
+#include "emi_writer.h"
+#include "emi_hash.h"
+#include "emi_archive.h"
+
+#ifdef Q_OS_UNIX
+#include <sys/stat.h>
+#endif
+
+#define EMI_MANIFEST_MAGIC "EMIMANIF"
+#define EMI_MANIFEST_VERSION 2
+
+typedef struct EMIManifestHeader
+{
+    char magic[8];
+    quint version;
+    quint rec_size; //!sizeof(MTKEMIInfo), a layout change parses everything again
+    quint entry_size;
+    quint entries;
+    qint64 heap_len;
+} EMIManifestHeader;
+
+template <typename T>
+static inline void put_le(qbyte &out, T val)
+{
+    out.append((const char*)&val, sizeof(T)); //!x86/arm hosts are little endian.
+}
+
+static inline void put_str(qbyte &out, const qstr &str)
+{
+    qbyte utf8 = str.toUtf8();
+    quint16 len = qMin<qsizetype>(utf8.size(), 0xffff);
+    put_le<quint16>(out, len);
+    out.append(utf8.constData(), len);
+}
+
+//!bounds checked reads over one stored result, a short record fails the whole load.
+typedef struct EMIRecordReader
+{
+    const char *data;
+    qint64 len;
+    qint64 pos;
+    bool ok;
+
+    template <typename T>
+    T get()
+    {
+        T val = {};
+        if (!ok || pos + (qint64)sizeof(T) > len)
+        {
+            ok = 0;
+            return val;
+        }
+        memcpy(&val, data + pos, sizeof(T));
+        pos += sizeof(T);
+        return val;
+    }
+
+    const char *get_raw(qint64 raw_len)
+    {
+        if (!ok || raw_len < 0 || pos + raw_len > len)
+        {
+            ok = 0;
+            return nullptr;
+        }
+        pos += raw_len;
+        return data + pos - raw_len;
+    }
+
+    qstr get_str()
+    {
+        quint16 str_len = get<quint16>();
+        const char *str = get_raw(str_len);
+        return str? qstr::fromUtf8(str, str_len): qstr();
+    }
+} EMIRecordReader;
+
+EMIManifest::EMIManifest(const qstr &path)
+{
+    m_path = path;
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) //!first run, everything is new.
+        return;
+
+    EMIManifestHeader hdr = {};
+    bool valid = m_file.size() >= (qint64)sizeof(hdr)
+            && m_file.read((char*)&hdr, sizeof(hdr)) == (qint64)sizeof(hdr)
+            && !memcmp(hdr.magic, EMI_MANIFEST_MAGIC, sizeof(hdr.magic))
+            && hdr.version == EMI_MANIFEST_VERSION
+            && hdr.rec_size == sizeof(mtkPreloader::MTKEMIInfo)
+            && hdr.entry_size == sizeof(EMIManifestEntry)
+            && hdr.heap_len >= 0
+            && m_file.size() == (qint64)(sizeof(hdr) + (qint64)hdr.entries * sizeof(EMIManifestEntry) + hdr.heap_len);
+    if (!valid)
+    {
+        m_file.close();
+        return;
+    }
+
+    m_map = m_file.map(0x00, m_file.size());
+    if (!m_map)
+    {
+        m_file.close();
+        return;
+    }
+    m_entries = (const EMIManifestEntry*)(m_map + sizeof(hdr));
+    m_heap = (const char*)(m_entries + hdr.entries);
+    m_heap_len = hdr.heap_len;
+
+    for (quint idx = 0; idx < hdr.entries; idx++)
+    {
+        const EMIManifestEntry &entry = m_entries[idx];
+        if (entry.result_off < 0 || entry.path_len > entry.result_len
+                || entry.result_off + entry.result_len > m_heap_len)
+            continue;
+        m_old.insert(qstr::fromUtf8(m_heap + entry.result_off, entry.path_len), idx);
+    }
+}
+
+EMIManifest::~EMIManifest()
+{
+    if (m_map)
+        m_file.unmap(m_map);
+    m_file.close();
+}
+
+bool EMIManifest::GetStamp(const qstr &file_path, EMIFileStamp &stamp)
+{
+    //!an archive member changes with its archive.
+    qstr path = file_path;
+    qstr member = {};
+    EMIArchive::SplitPath(file_path, path, member);
+
+#ifdef Q_OS_UNIX
+    //!block devices and pipes change without a new mtime, only regular files are kept.
+    struct stat st = {};
+    if (::stat(QFile::encodeName(path).constData(), &st) || !S_ISREG(st.st_mode))
+        return 0;
+
+    stamp.inode = st.st_ino;
+    stamp.size = st.st_size;
+#ifdef Q_OS_DARWIN
+    stamp.mtime_ns = st.st_mtimespec.tv_sec * 1000000000LL + st.st_mtimespec.tv_nsec;
+#else
+    stamp.mtime_ns = st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+#endif
+    return 1;
+#else
+    QFileInfo info(path);
+    if (!info.isFile())
+        return 0;
+
+    stamp.inode = 0;
+    stamp.size = info.size();
+    stamp.mtime_ns = info.lastModified().toMSecsSinceEpoch() * 1000000LL;
+    return 1;
+#endif
+}
+
+bool EMIManifest::entry_valid(const EMIManifestEntry &entry) const
+{
+    //!bounds only, the record itself is read once when it is handed out.
+    return entry.result_off >= 0 && entry.path_len <= entry.result_len
+            && entry.result_off + entry.result_len <= m_heap_len
+            && entry.blob_off >= 0 && entry.blob_off + entry.blob_len <= m_heap_len;
+}
+
+bool EMIManifest::load_result(const EMIManifestEntry &entry, EMIScanResult &result) const
+{
+    if (!entry_valid(entry))
+        return 0;
+
+    EMIRecordReader rec = {m_heap + entry.result_off, entry.result_len, entry.path_len, 1};
+    result.opened = 1;
+    result.header.identifier = rec.get_str();
+    result.header.platform = rec.get_str();
+    result.header.flash_dev = rec.get_str();
+    result.header.project_id = rec.get_str();
+    result.header.num_records = rec.get<quint>();
+    result.header.emi_ver = rec.get<quint>();
+
+    quint16 messages = rec.get<quint16>();
+    for (quint16 idx = 0; idx < messages && rec.ok; idx++)
+        result.messages << rec.get_str();
+
+    quint emis = rec.get<quint>();
+    const char *emi_data = rec.get_raw((qint64)emis * sizeof(mtkPreloader::MTKEMIInfo));
+    if (!rec.ok)
+        return 0;
+
+    result.emis.resize(emis);
+    memcpy(result.emis.data(), emi_data, (qint64)emis * sizeof(mtkPreloader::MTKEMIInfo));
+    result.blob = qbyte(m_heap + entry.blob_off, entry.blob_len);
+    return 1;
+}
+
+void EMIManifest::add_entry(EMIManifestEntry entry, const char *record, const char *blob)
+{
+    //!the same blob is in many dumps of one build, it is stored once.
+    if (entry.blob_len)
+    {
+        if (!m_new_blobs.contains(entry.blob_hash))
+        {
+            m_new_blobs.insert(entry.blob_hash, m_new_heap.size());
+            m_new_heap.append(blob, entry.blob_len);
+        }
+        entry.blob_off = m_new_blobs.value(entry.blob_hash);
+    }
+    else
+    {
+        entry.blob_off = 0;
+    }
+
+    entry.result_off = m_new_heap.size();
+    m_new_heap.append(record, entry.result_len);
+    m_new_entries.push_back(entry);
+}
+
+void EMIManifest::add_result(const EMIFileStamp &stamp, const EMIScanResult &result)
+{
+    qbyte record = result.path.toUtf8();
+    quint path_len = record.size();
+    put_str(record, result.header.identifier);
+    put_str(record, result.header.platform);
+    put_str(record, result.header.flash_dev);
+    put_str(record, result.header.project_id);
+    put_le<quint>(record, result.header.num_records);
+    put_le<quint>(record, result.header.emi_ver);
+
+    quint16 messages = qMin<qsizetype>(result.messages.size(), 0xffff);
+    put_le<quint16>(record, messages);
+    for (quint16 idx = 0; idx < messages; idx++)
+        put_str(record, result.messages.at(idx));
+
+    put_le<quint>(record, result.emis.size());
+    record.append((const char*)result.emis.constData(), result.emis.size() * sizeof(mtkPreloader::MTKEMIInfo));
+
+    EMIManifestEntry entry = {};
+    entry.inode = stamp.inode;
+    entry.size = stamp.size;
+    entry.mtime_ns = stamp.mtime_ns;
+    entry.blob_hash = result.blob.isEmpty()? 0: emi_xxh64(result.blob);
+    entry.result_len = record.size();
+    entry.blob_len = result.blob.size();
+    entry.path_len = path_len;
+    add_entry(entry, record.constData(), result.blob.constData());
+}
+
+void EMIManifest::Scan(EMIBatchScanner &scanner, const QStringList &files, const std::function<void(const EMIScanResult &)> &on_result)
+{
+    //!unchanged files keep their stored result, the rest goes through the pipeline.
+    QVector<EMIFileStamp> stamps(files.size());
+    QVector<bool> stamped(files.size());
+    QVector<int> reused(files.size()); //!old entry or -1 => parse
+    QVector<bool> is_first(files.size()); //!a path listed twice is stored once
+    QStringList changed = {};
+    QVector<int> changed_idx = {};
+
+    for (int idx = 0; idx < files.size(); idx++)
+    {
+        const qstr &path = files.at(idx);
+        stamped[idx] = GetStamp(path, stamps[idx]);
+        is_first[idx] = !m_seen.contains(path);
+        m_seen.insert(path);
+
+        //!loaded on its turn: the stored results aren't all held at once.
+        int old = m_old.value(path, -1);
+        if (!stamped.at(idx) || old == -1
+                || m_entries[old].inode != stamps.at(idx).inode
+                || m_entries[old].size != stamps.at(idx).size
+                || m_entries[old].mtime_ns != stamps.at(idx).mtime_ns
+                || !entry_valid(m_entries[old]))
+        {
+            old = -1;
+            changed << path;
+            changed_idx << idx;
+        }
+        reused[idx] = old;
+    }
+
+    int next = 0;
+    auto emit_reused = [&](int upto)
+    {
+        for (; next < upto; next++)
+        {
+            if (reused.at(next) == -1)
+                continue;
+
+            const EMIManifestEntry &entry = m_entries[reused.at(next)];
+            EMIScanResult result = {};
+            result.path = files.at(next);
+            if (!load_result(entry, result)) //!a damaged record => the file is parsed after all.
+            {
+                result = EMIScanResult();
+                scanner.ScanFile(files.at(next), result);
+                on_result(result);
+                if (result.opened && is_first.at(next))
+                    add_result(stamps.at(next), result);
+                m_parsed++;
+                continue;
+            }
+            if (scanner.writer())
+                scanner.writer()->Format(result, result.output);
+            on_result(result);
+
+            if (is_first.at(next))
+                add_entry(entry, m_heap + entry.result_off, m_heap + entry.blob_off);
+            m_skipped++;
+        }
+    };
+
+    int done = 0;
+    scanner.Scan(changed, [&](const EMIScanResult &result) {
+        int idx = changed_idx.at(done++);
+        emit_reused(idx);
+        on_result(result);
+        next = idx + 1;
+
+        if (result.opened && stamped.at(idx) && is_first.at(idx)) //!unreadable inputs are retried next run.
+            add_result(stamps.at(idx), result);
+        m_parsed++;
+    });
+    emit_reused(files.size());
+}
+
+bool EMIManifest::Save()
+{
+    //!files outside this run stay in the manifest while they exist.
+    for (QHash<qstr, int>::const_iterator it = m_old.constBegin(); it != m_old.constEnd(); ++it)
+    {
+        if (m_seen.contains(it.key()))
+            continue;
+
+        EMIFileStamp stamp = {};
+        if (!GetStamp(it.key(), stamp))
+        {
+            m_removed++;
+            continue;
+        }
+        const EMIManifestEntry &entry = m_entries[it.value()];
+        if (entry_valid(entry))
+            add_entry(entry, m_heap + entry.result_off, m_heap + entry.blob_off);
+    }
+
+    EMIManifestHeader hdr = {};
+    memcpy(hdr.magic, EMI_MANIFEST_MAGIC, sizeof(hdr.magic));
+    hdr.version = EMI_MANIFEST_VERSION;
+    hdr.rec_size = sizeof(mtkPreloader::MTKEMIInfo);
+    hdr.entry_size = sizeof(EMIManifestEntry);
+    hdr.entries = m_new_entries.size();
+    hdr.heap_len = m_new_heap.size();
+
+    //!everything is copied out of the old manifest, it can go before the new one replaces it.
+    if (m_map)
+        m_file.unmap(m_map);
+    m_map = nullptr;
+    m_file.close();
+    m_old.clear();
+
+    qint64 entries_len = (qint64)m_new_entries.size() * sizeof(EMIManifestEntry);
+    QSaveFile manifest_file(m_path);
+    if (!manifest_file.open(QIODevice::WriteOnly)
+            || manifest_file.write((const char*)&hdr, sizeof(hdr)) != (qint64)sizeof(hdr)
+            || manifest_file.write((const char*)m_new_entries.constData(), entries_len) != entries_len
+            || manifest_file.write(m_new_heap) != m_new_heap.size()
+            || !manifest_file.commit())
+    {
+        m_error = manifest_file.errorString();
+        return 0;
+    }
+    return 1;
+}
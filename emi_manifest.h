@@ -0,0 +1,78 @@
+#ifndef EMI_MANIFEST_H
+#define EMI_MANIFEST_H
+
+#include "emi_batch.h"
+
+//! identity of an input file on disk, a change in any field means it has to be parsed again.
+typedef struct EMIFileStamp
+{
+    qlong inode{0}; //!0 where the platform has none
+    qint64 size{0};
+    qint64 mtime_ns{0};
+} EMIFileStamp;
+
+//! incremental batch scan over a dump archive: the manifest keeps the parse result of every
+//! regular file it saw, keyed on its path and EMIFileStamp. a run only opens new or changed
+//! files, the others are handed to on_result from the stored result (in input order, through
+//! the scanner's writer). entries of files that are gone are dropped on Save().
+//!
+//! layout (little endian, native MTKEMIInfo):
+//!   EMIManifestHeader
+//!   EMIManifestEntry[entries]
+//!   heap: per entry utf-8 path + result, MTK_BLOADER_INFO blobs stored once per xxh64
+class EMIManifest
+{
+public:
+    EMIManifest(const qstr &path);
+    ~EMIManifest();
+
+    void Scan(EMIBatchScanner &scanner, const QStringList &files, const std::function<void(const EMIScanResult &)> &on_result);
+    bool Save(); //!entries of this run plus the old ones whose files still exist
+
+    static bool GetStamp(const qstr &path, EMIFileStamp &stamp); //!0 => not a regular file
+    qstr errorString() const { return m_error; }
+    int parsed() const { return m_parsed; }
+    int skipped() const { return m_skipped; }
+    int removed() const { return m_removed; }
+private:
+    Q_DISABLE_COPY(EMIManifest)
+
+    typedef struct EMIManifestEntry
+    {
+        qlong inode;
+        qint64 size;
+        qint64 mtime_ns;
+        qlong blob_hash; //!xxh64 of the blob, 0 = none
+        qint64 result_off; //!heap offsets
+        qint64 blob_off;
+        quint result_len; //!path included
+        quint blob_len;
+        quint path_len;
+        quint reserved;
+    } EMIManifestEntry;
+
+    bool entry_valid(const EMIManifestEntry &entry) const;
+    bool load_result(const EMIManifestEntry &entry, EMIScanResult &result) const;
+    void add_result(const EMIFileStamp &stamp, const EMIScanResult &result);
+    void add_entry(EMIManifestEntry entry, const char *record, const char *blob);
+
+    qstr m_path{};
+    QFile m_file{};
+    uchar *m_map{nullptr}; //!the manifest of the last run
+    const EMIManifestEntry *m_entries{nullptr};
+    const char *m_heap{nullptr};
+    qint64 m_heap_len{0};
+    QHash<qstr, int> m_old{}; //!path => old entry
+
+    QVector<EMIManifestEntry> m_new_entries{}; //!what Save() writes
+    qbyte m_new_heap{};
+    QHash<qlong, qint64> m_new_blobs{}; //!blob hash => heap offset
+    QSet<qstr> m_seen{};
+
+    int m_parsed{0};
+    int m_skipped{0};
+    int m_removed{0};
+    qstr m_error{};
+};
+
+#endif // EMI_MANIFEST_H
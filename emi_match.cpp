@@ -0,0 +1,92 @@
+#include "emi_match.h"
+
+EMIMatcher::EMIMatcher(const QVector<mtkPreloader::MTKEMIInfo> &emis) : m_emis(emis)
+{
+    //!load factor stays at or below 1/2, there is always an empty slot to stop at.
+    quint pow2 = 0x10;
+    while (pow2 < (quint)m_emis.size() * 2)
+        pow2 <<= 1;
+    m_mask = pow2 - 1;
+
+    EMIMatchSlot empty = {0, -1, -1};
+    m_slots.fill(empty, pow2);
+    m_next.fill(-1, m_emis.size());
+
+    for (int pos = 0; pos < m_emis.size(); pos++)
+    {
+        const mtkPreloader::MTKEMIInfo &emi = m_emis.at(pos);
+        if (!emi.id_len || !(emi.dram_type & 0x0F00)) //!discrete dram, no flash id to match.
+            continue;
+
+        bool known = 0;
+        for (const EMIMatchGroup &group : m_groups)
+            known |= group.id_len == emi.id_len && group.is_ufs == emi.is_ufs;
+        if (!known)
+        {
+            EMIMatchGroup group = {emi.id_len, emi.is_ufs};
+            m_groups.push_back(group);
+        }
+
+        qlong key = get_key(emi.flash_id, emi.id_len, emi.is_ufs);
+        EMIMatchSlot &slot = m_slots[find_slot(key, emi.flash_id, emi.id_len, emi.is_ufs)];
+        if (slot.key)
+        {
+            m_next[slot.last] = pos;
+            slot.last = pos;
+            continue;
+        }
+        slot.key = key;
+        slot.first = pos;
+        slot.last = pos;
+    }
+}
+
+qlong EMIMatcher::get_key(const qchar *dev_id, quint8 id_len, bool is_ufs)
+{
+    qlong key = emi_xxh64((const char*)dev_id, id_len, id_len | (is_ufs << 8));
+    return key? key: 1;
+}
+
+qsizetype EMIMatcher::find_slot(qlong key, const qchar *dev_id, quint8 id_len, bool is_ufs) const
+{
+    for (quint idx = (quint)(key ^ (key >> 32)) & m_mask;; idx = (idx + 1) & m_mask)
+    {
+        const EMIMatchSlot &slot = m_slots.at(idx);
+        if (!slot.key)
+            return idx;
+
+        const mtkPreloader::MTKEMIInfo &emi = m_emis.at(slot.first);
+        if (slot.key == key && emi.id_len == id_len && emi.is_ufs == is_ufs
+                && !memcmp(emi.flash_id, dev_id, id_len))
+            return idx;
+    }
+}
+
+bool EMIMatcher::fw_id_matches(const mtkPreloader::MTKEMIInfo &emi, const qbyte &fw_id)
+{
+    if (!emi.fw_id_len || fw_id.isEmpty())
+        return 1;
+    return fw_id.size() >= emi.fw_id_len && !memcmp(emi.fw_id, fw_id.constData(), emi.fw_id_len);
+}
+
+int EMIMatcher::Match(const qchar *dev_id, qsizetype len, bool is_ufs, const qbyte &fw_id) const
+{
+    int best = -1;
+    for (const EMIMatchGroup &group : m_groups)
+    {
+        if (group.is_ufs != is_ufs || group.id_len > len)
+            continue;
+
+        const EMIMatchSlot &slot = m_slots.at(find_slot(get_key(dev_id, group.id_len, is_ufs), dev_id, group.id_len, is_ufs));
+        //!the chain is in blob order, past the best so far nothing can win anymore.
+        for (int pos = slot.first; pos != -1 && (best == -1 || pos < best); pos = m_next.at(pos))
+        {
+            if (fw_id_matches(m_emis.at(pos), fw_id))
+            {
+                best = pos;
+                break;
+            }
+        }
+    }
+    return best;
+}
@@ -0,0 +1,47 @@
+#ifndef EMI_MATCH_H
+#define EMI_MATCH_H
+
+#include "emi_hash.h"
+
+//! the preloader's EMI selection over the records of one MTK_BLOADER_INFO: it boots with
+//! the first record (blob order) of the device storage kind whose id equals the first
+//! m_id_length bytes of the device CID / UFS id and, when fw_id_length is set, whose
+//! m_fw_id equals the first fw_id_length bytes of the device firmware id.
+//! discrete dram records are picked by the dram mode registers instead and never match.
+//! the records are hashed once on (kind, id length, id prefix); a query costs one probe
+//! per distinct id length in the blob, usually one or two.
+class EMIMatcher
+{
+public:
+    EMIMatcher(const QVector<mtkPreloader::MTKEMIInfo> &emis);
+    ~EMIMatcher(){};
+
+    //!position in emis of the record the preloader boots with, -1 => none.
+    //!an empty fw_id skips the firmware id check, the caller doesn't know it.
+    int Match(const qchar *dev_id, qsizetype len, bool is_ufs, const qbyte &fw_id = qbyte()) const;
+private:
+    typedef struct EMIMatchSlot
+    {
+        qlong key; //!0 = empty
+        int first; //!first record with this prefix, m_next chains the others in blob order
+        int last;
+    } EMIMatchSlot;
+
+    typedef struct EMIMatchGroup
+    {
+        quint8 id_len;
+        bool is_ufs;
+    } EMIMatchGroup;
+
+    static qlong get_key(const qchar *dev_id, quint8 id_len, bool is_ufs);
+    qsizetype find_slot(qlong key, const qchar *dev_id, quint8 id_len, bool is_ufs) const;
+    static bool fw_id_matches(const mtkPreloader::MTKEMIInfo &emi, const qbyte &fw_id);
+
+    QVector<mtkPreloader::MTKEMIInfo> m_emis{};
+    QVector<EMIMatchGroup> m_groups{};
+    QVector<EMIMatchSlot> m_slots{};
+    QVector<int> m_next{};
+    quint m_mask{0};
+};
+
+#endif // EMI_MATCH_H
@@ -0,0 +1,318 @@
+#include "emi_pipeline.h"
+#include "emi_batch.h"
+#include "emi_writer.h"
+
+#if defined(Q_OS_UNIX) && !defined(Q_OS_DARWIN)
+#include <fcntl.h>
+#define EMI_HAVE_FADVISE
+#endif
+
+enum EMIStage
+{
+    EMI_STAGE_PREFETCH = 0,
+    EMI_STAGE_LOCATE = 1,
+    EMI_STAGE_DECODE = 2,
+};
+
+//!one input on its way through the stages.
+struct EMIScanItem
+{
+    int idx{0};
+    QScopedPointer<QIODevice> emi_dev{};
+    EMIParser parser{};
+    bool located{0};
+    EMIScanResult result{};
+};
+
+//! EMIRing plus a free/used semaphore pair so an idle stage sleeps instead of spinning.
+//! a nullptr item tells one consumer to stop.
+class EMIStageQueue
+{
+public:
+    EMIStageQueue(const char *name, int capacity) : m_ring(capacity), m_free(m_ring.capacity())
+    {
+        m_name = name;
+    }
+
+    void Push(EMIScanItem *item)
+    {
+        m_free.acquire();
+        while (!m_ring.TryPush(item)) //!only while a consumer is between its pop and its release.
+            QThread::yieldCurrentThread();
+        m_used.release();
+
+        int occupancy = m_used.available();
+        m_pushes.fetchAndAddRelaxed(1);
+        m_occupancy.fetchAndAddRelaxed(occupancy);
+        int max_occupancy = m_max.loadRelaxed();
+        while (occupancy > max_occupancy && !m_max.testAndSetRelaxed(max_occupancy, occupancy))
+            max_occupancy = m_max.loadRelaxed();
+    }
+
+    EMIScanItem *Pop()
+    {
+        m_used.acquire();
+        EMIScanItem *item = nullptr;
+        while (!m_ring.TryPop(item))
+            QThread::yieldCurrentThread();
+        m_free.release();
+        return item;
+    }
+
+    EMIQueueStats stats() const
+    {
+        EMIQueueStats stats = {};
+        stats.name = m_name;
+        stats.capacity = m_ring.capacity();
+        stats.pushes = m_pushes.loadAcquire();
+        stats.occupancy = m_occupancy.loadAcquire();
+        stats.max_occupancy = m_max.loadAcquire();
+        return stats;
+    }
+private:
+    const char *m_name{""};
+    EMIRing<EMIScanItem> m_ring;
+    QSemaphore m_free;
+    QSemaphore m_used{0};
+    QAtomicInteger<qint64> m_pushes{0};
+    QAtomicInteger<qint64> m_occupancy{0};
+    QAtomicInteger<int> m_max{0};
+};
+
+//!shared by the stage threads and the reporting thread.
+struct EMIPipelineState
+{
+    EMIPipelineState(const EMIBatchScanner &scanner, int jobs) :
+        scanner(scanner), to_locate("prefetch=>locate", jobs * 4), to_decode("locate=>decode", jobs * 2) {}
+
+    const EMIBatchScanner &scanner;
+    QStringList files{};
+    QVector<EMIScanResult> results{};
+    QVector<bool> done{};
+    QAtomicInt next{0}; //!next file to prefetch
+    QAtomicInt prefetchers{0}; //!running, the last one out stops the locate threads
+    QAtomicInt locators{0}; //!running, the last one out stops the decode threads
+    int decoders{0};
+    int emitted{0}; //!files handed to on_result so far.
+    int window{0}; //!max prefetched-but-not-emitted results.
+    EMIStageQueue to_locate;
+    EMIStageQueue to_decode;
+    EMIStageStats stages[3]{};
+    QMutex lock{};
+    QWaitCondition result_ready{};
+    QWaitCondition slot_free{};
+};
+
+//!a head start for the locate stage, returns the bytes asked for.
+static qint64 prefetch_head(QIODevice &emi_dev)
+{
+    //!EMIBlockDevice bypasses the page cache, pipes can't be read twice.
+    QFileDevice *file = qobject_cast<QFileDevice*>(&emi_dev);
+    if (!file || file->isSequential())
+        return 0;
+
+    qint64 len = qMin<qint64>(file->size(), EMI_PREFETCH_LEN);
+#ifdef EMI_HAVE_FADVISE
+    if (!posix_fadvise(file->handle(), 0x00, len, POSIX_FADV_WILLNEED))
+        return len;
+#endif
+
+    //!no readahead hint here => read the head on this thread, locate then finds it cached.
+    qbyte chunk(EMI_READ_CHUNK, Qt::Uninitialized);
+    qint64 done = 0;
+    while (done < len)
+    {
+        qint64 read_len = file->read(chunk.data(), qMin<qint64>(chunk.size(), len - done));
+        if (read_len <= 0)
+            break;
+        done += read_len;
+    }
+    file->seek(0x00);
+    return done;
+}
+
+class EMIStageWorker : public QRunnable
+{
+public:
+    EMIStageWorker(EMIPipelineState &state, EMIStage stage) : m_state(state), m_stage(stage) {}
+
+    void run() override
+    {
+        EMIStageStats local = {};
+        if (m_stage == EMI_STAGE_PREFETCH)
+            prefetch(local);
+        else if (m_stage == EMI_STAGE_LOCATE)
+            locate(local);
+        else
+            decode(local);
+
+        QMutexLocker locker(&m_state.lock);
+        EMIStageStats &stats = m_state.stages[m_stage];
+        stats.threads++;
+        stats.items += local.items;
+        stats.bytes += local.bytes;
+        stats.busy_ns += local.busy_ns;
+    }
+private:
+    void prefetch(EMIStageStats &local)
+    {
+        forever
+        {
+            int idx = m_state.next.fetchAndAddRelaxed(1);
+            if (idx >= m_state.files.size())
+                break;
+
+            {
+                //!don't run too far ahead of a slow file.
+                QMutexLocker locker(&m_state.lock);
+                while (idx >= m_state.emitted + m_state.window)
+                    m_state.slot_free.wait(&m_state.lock);
+            }
+
+            QElapsedTimer timer;
+            timer.start();
+            EMIScanItem *item = new EMIScanItem;
+            item->idx = idx;
+            item->emi_dev.reset(m_state.scanner.OpenInput(m_state.files.at(idx), item->result));
+            if (item->emi_dev)
+                local.bytes += prefetch_head(*item->emi_dev);
+            local.items++;
+            local.busy_ns += timer.nsecsElapsed();
+
+            m_state.to_locate.Push(item);
+        }
+
+        if (!m_state.prefetchers.deref())
+        {
+            for (int i = 0; i < m_state.locators.loadAcquire(); i++)
+                m_state.to_locate.Push(nullptr);
+        }
+    }
+
+    void locate(EMIStageStats &local)
+    {
+        while (EMIScanItem *item = m_state.to_locate.Pop())
+        {
+            QElapsedTimer timer;
+            timer.start();
+            if (item->emi_dev)
+            {
+                item->parser.setBlobSink(m_state.scanner.blobSink());
+                item->parser.setCache(m_state.scanner.cache());
+                item->located = item->parser.Locate(*item->emi_dev);
+                local.bytes += item->parser.scanned();
+                item->emi_dev.reset(); //!the blob is copied, the input can go.
+            }
+            local.items++;
+            local.busy_ns += timer.nsecsElapsed();
+
+            m_state.to_decode.Push(item);
+        }
+
+        if (!m_state.locators.deref())
+        {
+            for (int i = 0; i < m_state.decoders; i++)
+                m_state.to_decode.Push(nullptr);
+        }
+    }
+
+    void decode(EMIStageStats &local)
+    {
+        while (EMIScanItem *item = m_state.to_decode.Pop())
+        {
+            QElapsedTimer timer;
+            timer.start();
+            EMIScanResult &result = item->result;
+            if (result.opened)
+            {
+                if (item->located)
+                    item->parser.Decode(result.emis);
+                result.messages << item->parser.messages(); //!after what OpenInput noted
+                result.header = item->parser.header();
+                result.blob = item->parser.blob();
+            }
+            if (m_state.scanner.writer()) //!format here, the reporting thread only copies bytes out.
+                m_state.scanner.writer()->Format(result, result.output);
+            local.bytes += result.blob.size();
+            local.items++;
+            local.busy_ns += timer.nsecsElapsed();
+
+            int idx = item->idx;
+            QMutexLocker locker(&m_state.lock);
+            m_state.results[idx] = std::move(result);
+            m_state.done[idx] = 1;
+            m_state.result_ready.wakeAll();
+            locker.unlock();
+            delete item;
+        }
+    }
+
+    EMIPipelineState &m_state;
+    EMIStage m_stage{EMI_STAGE_PREFETCH};
+};
+
+EMIScanPipeline::EMIScanPipeline(const EMIBatchScanner &scanner) : m_scanner(scanner)
+{
+}
+
+void EMIScanPipeline::Run(const QStringList &files, const std::function<void(const EMIScanResult &)> &on_result)
+{
+    m_stats = EMIPipelineStats();
+    if (files.isEmpty())
+        return;
+
+    QElapsedTimer wall;
+    wall.start();
+
+    int jobs = m_scanner.jobs();
+    EMIPipelineState state(m_scanner, jobs);
+    state.files = files;
+    state.results.resize(files.size());
+    state.done.fill(0, files.size());
+    state.window = jobs * 0x40;
+
+    //!prefetch mostly waits on open() and the disk, decode is the cheap part.
+    int prefetchers = qBound(1, jobs / 2, files.size());
+    int locators = qBound(1, jobs, files.size());
+    state.decoders = qBound(1, jobs / 4, files.size());
+    state.prefetchers.storeRelease(prefetchers);
+    state.locators.storeRelease(locators);
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(prefetchers + locators + state.decoders);
+    for (int i = 0; i < state.decoders; i++)
+        pool.start(new EMIStageWorker(state, EMI_STAGE_DECODE));
+    for (int i = 0; i < locators; i++)
+        pool.start(new EMIStageWorker(state, EMI_STAGE_LOCATE));
+    for (int i = 0; i < prefetchers; i++)
+        pool.start(new EMIStageWorker(state, EMI_STAGE_PREFETCH));
+
+    for (int idx = 0; idx < files.size(); idx++)
+    {
+        EMIScanResult result = {};
+        {
+            QMutexLocker locker(&state.lock);
+            while (!state.done.at(idx))
+                state.result_ready.wait(&state.lock);
+
+            result = std::move(state.results[idx]);
+            state.results[idx] = EMIScanResult();
+            state.emitted++;
+            state.slot_free.wakeAll();
+        }
+
+        on_result(result);
+    }
+
+    pool.waitForDone();
+
+    m_stats.wall_ns = wall.nsecsElapsed();
+    const char *names[] = {"prefetch", "locate", "decode"};
+    for (int stage = 0; stage < 3; stage++)
+    {
+        m_stats.stages[stage] = state.stages[stage];
+        m_stats.stages[stage].name = names[stage];
+    }
+    m_stats.queues[0] = state.to_locate.stats();
+    m_stats.queues[1] = state.to_decode.stats();
+}
@@ -0,0 +1,132 @@
+#ifndef EMI_PIPELINE_H
+#define EMI_PIPELINE_H
+
+#include "emi_structures.h"
+
+#include <functional>
+
+#define EMI_PREFETCH_LEN 0x400000 //!4M readahead hint, a whole boot0 dump or preloader
+
+class EMIBatchScanner;
+struct EMIScanResult;
+
+//! bounded multi producer / multi consumer ring of pointers (Vyukov), push and pop
+//! never take a lock; a full ring fails TryPush, an empty one TryPop.
+template <typename T>
+class EMIRing
+{
+public:
+    explicit EMIRing(int capacity)
+    {
+        quint pow2 = 2;
+        while (pow2 < (quint)capacity)
+            pow2 <<= 1;
+        m_mask = pow2 - 1;
+        m_cells = new Cell[pow2];
+        for (quint idx = 0; idx < pow2; idx++)
+            m_cells[idx].seq.storeRelaxed(idx);
+    }
+    ~EMIRing() { delete[] m_cells; }
+
+    int capacity() const { return (int)m_mask + 1; }
+
+    bool TryPush(T *val)
+    {
+        quint pos = m_tail.loadRelaxed();
+        forever
+        {
+            Cell &cell = m_cells[pos & m_mask];
+            int diff = (int)(cell.seq.loadAcquire() - pos); //!positions wrap, the distance doesn't
+            if (diff < 0)
+                return 0;
+            if (diff == 0 && m_tail.testAndSetRelaxed(pos, pos + 1))
+            {
+                cell.val = val;
+                cell.seq.storeRelease(pos + 1);
+                return 1;
+            }
+            pos = m_tail.loadRelaxed();
+        }
+    }
+
+    bool TryPop(T *&val)
+    {
+        quint pos = m_head.loadRelaxed();
+        forever
+        {
+            Cell &cell = m_cells[pos & m_mask];
+            int diff = (int)(cell.seq.loadAcquire() - (pos + 1));
+            if (diff < 0)
+                return 0;
+            if (diff == 0 && m_head.testAndSetRelaxed(pos, pos + 1))
+            {
+                val = cell.val;
+                cell.seq.storeRelease(pos + m_mask + 1);
+                return 1;
+            }
+            pos = m_head.loadRelaxed();
+        }
+    }
+private:
+    Q_DISABLE_COPY(EMIRing)
+
+    struct Cell
+    {
+        QAtomicInteger<quint> seq{0};
+        T *val{nullptr};
+    };
+
+    Cell *m_cells{nullptr};
+    quint m_mask{0};
+    QAtomicInteger<quint> m_head{0};
+    QAtomicInteger<quint> m_tail{0};
+};
+
+typedef struct EMIStageStats
+{
+    const char *name{""};
+    int threads{0};
+    qint64 items{0};
+    qint64 bytes{0}; //!prefetch: hinted, locate: scanned, decode: blob
+    qint64 busy_ns{0}; //!summed over the stage threads
+} EMIStageStats;
+
+typedef struct EMIQueueStats
+{
+    const char *name{""};
+    int capacity{0};
+    qint64 pushes{0};
+    qint64 occupancy{0}; //!summed after every push
+    int max_occupancy{0};
+} EMIQueueStats;
+
+typedef struct EMIPipelineStats
+{
+    qint64 wall_ns{0};
+    EMIStageStats stages[3]{}; //!prefetch, locate, decode
+    EMIQueueStats queues[2]{}; //!prefetch => locate, locate => decode
+} EMIPipelineStats;
+
+//! the batch scan split into three stages so the disk and the cpus stay busy together:
+//!   prefetch : opens the input and hints the kernel to read its head ahead (posix_fadvise,
+//!              or a thread reading it where there is no such hint)
+//!   locate   : magic check and the MTK_BLOADER_INFO search, EMIParser::Locate()
+//!   decode   : records, cache and writer, EMIParser::Decode()
+//! the stages hand items over EMIRing queues; a semaphore pair only parks a thread
+//! when its queue is full or empty. results still come back in input order.
+class EMIScanPipeline
+{
+public:
+    EMIScanPipeline(const EMIBatchScanner &scanner);
+    ~EMIScanPipeline(){};
+
+    void Run(const QStringList &files, const std::function<void(const EMIScanResult &)> &on_result);
+    const EMIPipelineStats &stats() const { return m_stats; }
+private:
+    Q_DISABLE_COPY(EMIScanPipeline)
+
+    const EMIBatchScanner &m_scanner;
+    EMIPipelineStats m_stats{};
+};
+
+#endif // EMI_PIPELINE_H
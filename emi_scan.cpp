@@ -0,0 +1,100 @@
+#include "emi_scan.h"
+#include "emi_find.h"
+
+#define EMI_SCAN_BLOCK 0x10000 //!64K, stays in L1/L2 while the needles run over it
+
+EMIMultiScanner::EMIMultiScanner(const QVector<qbyte> &needles)
+{
+    Q_ASSERT(needles.size() <= 8);
+
+    for (const qbyte &needle : needles)
+    {
+        if (needle.isEmpty() || m_needles.size() == 8)
+            continue;
+        m_needles.push_back(needle);
+    }
+}
+
+//!first match of needle starting in [from, to), to <= len - needle.size() + 1.
+static inline qsizetype find_needle(const char *data, qsizetype from, qsizetype to, const qbyte &needle)
+{
+    qsizetype pos = EMIFind(data + from, to - from + needle.size() - 1, needle.constData(), needle.size());
+    return (pos == -1)?-1: from + pos;
+}
+
+void EMIMultiScanner::Scan(const char *data, qsizetype len, qsizetype *first, qsizetype scanned) const
+{
+    quint8 pending = 0;
+    qsizetype start = len;
+    for (int id = 0; id < m_needles.size(); id++)
+    {
+        if (!scanned)
+            first[id] = -1;
+
+        const qbyte &needle = m_needles.at(id);
+        if (first[id] == -1 && needle.size() <= len)
+        {
+            pending |= (1 << id);
+            start = qMin(start, qMax<qsizetype>(0, scanned - needle.size() + 1));
+        }
+    }
+
+    for (qsizetype block = start; block < len && pending; block += EMI_SCAN_BLOCK)
+    {
+        for (int id = 0; id < m_needles.size(); id++)
+        {
+            if (!(pending & (1 << id)))
+                continue;
+
+            //!matches starting before scanned - size + 1 were seen last time.
+            const qbyte &needle = m_needles.at(id);
+            qsizetype from = qMax(block, scanned - needle.size() + 1);
+            qsizetype to = qMin(block + EMI_SCAN_BLOCK, len - needle.size() + 1);
+            if (from >= to)
+                continue;
+
+            first[id] = find_needle(data, from, to, needle);
+            if (first[id] != -1)
+                pending &= ~(1 << id);
+        }
+    }
+}
+
+void FindEMIAnchors(const qbyte &emi_buf, EMIAnchors &anchors, qsizetype scanned)
+{
+    static const EMIMultiScanner scanner(QVector<qbyte>() << "AND_ROMINFO_v"
+                                                          << "bootable/bootloader/preloader/platform/mt"
+                                                          << "preloader_"
+                                                          << MTK_BLOADER_INFO_BEGIN);
+
+    qsizetype first[4] = {anchors.rom_info, anchors.platform_path, anchors.pl_name, anchors.bldr_info};
+    scanner.Scan(emi_buf.constData(), emi_buf.size(), first, scanned);
+
+    anchors.rom_info = first[0];
+    anchors.platform_path = first[1];
+    anchors.pl_name = first[2];
+    anchors.bldr_info = first[3];
+
+    //!parsed again as the data grows, the tag may have been cut by the end of a chunk.
+    if (anchors.bldr_info != -1)
+        anchors.bldr_ver = GetEMIVersion(emi_buf.constData() + anchors.bldr_info,
+                                         qMin<qsizetype>(0x1b, emi_buf.size() - anchors.bldr_info)); //!m_identifier
+}
+
+qint16 GetEMIVersion(const char *tag, qsizetype len)
+{
+    qsizetype idx = strlen(MTK_BLOADER_INFO_BEGIN);
+    if (len <= idx || memcmp(tag, MTK_BLOADER_INFO_BEGIN, idx))
+        return -1;
+
+    qint16 emi_ver = 0;
+    qsizetype digits = 0;
+    for (; idx < len && tag[idx]; idx++, digits++)
+    {
+        if (tag[idx] < '0' || tag[idx] > '9' || digits == 3)
+            return -1;
+        emi_ver = emi_ver * 10 + (tag[idx] - '0');
+    }
+
+    return (!digits || emi_ver > 0xff)? -1: emi_ver;
+}
@@ -0,0 +1,44 @@
+#ifndef EMI_SCAN_H
+#define EMI_SCAN_H
+
+#include "emi_structures.h"
+
+//! finds the first offset of up to 8 needles in one pass over the data.
+//! the data is walked in cache sized blocks and every pending needle is
+//! searched in a block (EMIFind) while it is still hot, memory is read once
+//! no matter how many needles there are.
+class EMIMultiScanner
+{
+public:
+    EMIMultiScanner(const QVector<qbyte> &needles);
+    ~EMIMultiScanner(){};
+
+    int count() const { return m_needles.size(); }
+    const qbyte &needle(int id) const { return m_needles.at(id); }
+
+    //!first[id] = offset of needle id or -1, stops once every needle was seen.
+    //!scanned > 0 => data grew past the scanned bytes, first[] holds the results
+    //!for them and only needles still at -1 are looked for in the new bytes.
+    void Scan(const char *data, qsizetype len, qsizetype *first, qsizetype scanned = 0) const;
+private:
+    QVector<qbyte> m_needles{};
+};
+
+//! first offsets of the strings the parser looks for in a preloader/boot region image.
+typedef struct EMIAnchors
+{
+    qsizetype rom_info{-1}; //!AND_ROMINFO_v
+    qsizetype platform_path{-1}; //!bootable/bootloader/preloader/platform/mt
+    qsizetype pl_name{-1}; //!preloader_
+    qsizetype bldr_info{-1}; //!MTK_BLOADER_INFO_v
+    qint16 bldr_ver{-1}; //!XX of the MTK_BLOADER_INFO_vXX at bldr_info
+} EMIAnchors;
+
+//! scanned => see EMIMultiScanner::Scan, anchors keeps the earlier results.
+void FindEMIAnchors(const qbyte &emi_buf, EMIAnchors &anchors, qsizetype scanned = 0);
+
+//! XX of a MTK_BLOADER_INFO_vXX tag: decimal digits up to the first NUL
+//! or len, -1 when the tag is malformed or above 0xff.
+qint16 GetEMIVersion(const char *tag, qsizetype len);
+
+#endif // EMI_SCAN_H
@@ -0,0 +1,67 @@
+#include "emi_sink.h"
+
+class EMIBlobWriter : public QRunnable
+{
+public:
+    EMIBlobWriter(EMIBlobSink &sink, const qstr &path, const qbyte &emi_blob) :
+        m_sink(sink), m_path(path), m_blob(emi_blob) {}
+
+    void run() override
+    {
+        QSaveFile blob_file(m_path);
+        if (blob_file.open(QIODevice::WriteOnly)
+                && blob_file.write(m_blob) == m_blob.size()
+                && blob_file.commit())
+            m_sink.m_written.fetchAndAddRelaxed(1);
+        else
+            m_sink.m_failed.fetchAndAddRelaxed(1);
+    }
+private:
+    EMIBlobSink &m_sink;
+    qstr m_path{};
+    qbyte m_blob{};
+};
+
+EMIBlobSink::EMIBlobSink(const qstr &out_dir, int writers)
+{
+    m_out_dir = out_dir.isEmpty()?qstr("."): out_dir;
+    QDir().mkpath(m_out_dir);
+    m_writers.setMaxThreadCount(qMax(writers, 1));
+}
+
+EMIBlobSink::~EMIBlobSink()
+{
+    WaitForDone();
+}
+
+void EMIBlobSink::Submit(quint8 emi_ver, const qbyte &emi_blob)
+{
+    if (emi_blob.isEmpty())
+        return;
+
+    qlong hash = emi_xxh64(emi_blob.constData(), emi_blob.size());
+    {
+        QMutexLocker locker(&m_lock);
+        if (m_seen.contains(hash))
+        {
+            m_duplicates.fetchAndAddRelaxed(1);
+            return;
+        }
+        m_seen.insert(hash);
+    }
+
+    qstr path = QDir(m_out_dir).filePath(qstr("MTK_BLOADER_INFO_v%0_%1.bin").arg((int)emi_ver, 2, 10, QLatin1Char('0')).arg(emi_hash_name(hash)));
+    if (QFileInfo(path).size() == emi_blob.size()) //!extracted by an earlier run.
+    {
+        m_duplicates.fetchAndAddRelaxed(1);
+        return;
+    }
+
+    //!deep copy, the view may point into a mapping that is about to go away.
+    m_writers.start(new EMIBlobWriter(*this, path, qbyte(emi_blob.constData(), emi_blob.size())));
+}
+
+void EMIBlobSink::WaitForDone()
+{
+    m_writers.waitForDone();
+}
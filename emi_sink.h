@@ -0,0 +1,36 @@
+#ifndef EMI_SINK_H
+#define EMI_SINK_H
+
+#include "emi_hash.h"
+
+//! opt-in MTK_BLOADER_INFO blob extraction.
+//! blobs are stored as <out_dir>/MTK_BLOADER_INFO_vXX_<xxh64>.bin, each distinct blob is
+//! written once, off the parsing thread (temp file + rename).
+class EMIBlobSink
+{
+public:
+    EMIBlobSink(const qstr &out_dir, int writers = 1);
+    ~EMIBlobSink();
+
+    //!emi_blob may be a raw view, it's copied only when it has to be written.
+    void Submit(quint8 emi_ver, const qbyte &emi_blob);
+    void WaitForDone();
+
+    qstr outDir() const { return m_out_dir; }
+    int written() const { return m_written.loadAcquire(); }
+    int duplicates() const { return m_duplicates.loadAcquire(); }
+    int failed() const { return m_failed.loadAcquire(); }
+private:
+    Q_DISABLE_COPY(EMIBlobSink)
+    friend class EMIBlobWriter;
+
+    qstr m_out_dir{};
+    QThreadPool m_writers{};
+    QMutex m_lock{};
+    QSet<qlong> m_seen{}; //!guarded by m_lock
+    QAtomicInt m_written{0};
+    QAtomicInt m_duplicates{0};
+    QAtomicInt m_failed{0};
+};
+
+#endif // EMI_SINK_H
@@ -17,8 +17,11 @@ using namespace std;
 #define UFS_VENDOR_TOSHIBA     0x198
 #define UFS_VENDOR_SAMSUNG     0x1CE
 #define UFS_VENDOR_SKHYNIX     0x1AD
+#define UFS_VENDOR_KIOXIA      0x198 //!took over the Toshiba id
+#define UFS_VENDOR_WDC         0x145
 
 #define MTK_BLOADER_INFO_BEGIN	"MTK_BLOADER_INFO_v"
+#define MTK_BIN_IDENTIFIER "MTK_BIN" //!MTK_BLOADER_INFO m_bin_identifier
 
 namespace mtkPreloader {
 
@@ -650,46 +653,115 @@ public:
     unsigned int emi_len[40];
 } EMIInfoV51;
 
+//!where the fields of one EMIInfoVxx record live, see EMI_LAYOUT.
+typedef struct EMILayout
+{
+    quint8 emi_ver; //!MTK_BLOADER_INFO_vXX
+    quint16 cfg_len; //!sizeof(emi_cfg)
+    quint16 rec_len; //!sizeof(emi_len) => record stride
+    quint16 type_off; //!m_type
+    quint16 id_off; //!m_emmc_id / m_ufs_id
+    quint16 id_size;
+    qint16 id_len_off; //!m_id_length or EMI_NO_ID_LEN
+    qint16 fw_len_off; //!fw_id_length or EMI_NO_FW_LEN
+    quint16 fw_id_off; //!m_fw_id
+    quint16 rank_off; //!m_dram_rank_size[4]
+    quint8 rank_width; //!quint / qlong
+    bool combo; //!eMMC + UFS ids, told apart by m_id_length
+} EMILayout;
+
+#define EMI_NO_ID_LEN -1 //!the whole id field is compared
+#define EMI_ID_LEN(emi_type) offsetof(emi_type, emi_cfg.m_id_length)
+#define EMI_NO_FW_LEN -1
+#define EMI_NO_FW_ID EMI_NO_FW_LEN, 0 //!no firmware id check
+#define EMI_FW_ID(emi_type) offsetof(emi_type, emi_cfg.fw_id_length), offsetof(emi_type, emi_cfg.m_fw_id)
+#define EMI_LAYOUT(ver, emi_type, id, id_len_off, fw_id, combo) \
+    {ver, sizeof(((emi_type*)0)->emi_cfg), sizeof(((emi_type*)0)->emi_len), \
+     offsetof(emi_type, emi_cfg.m_type), offsetof(emi_type, emi_cfg.id), sizeof(((emi_type*)0)->emi_cfg.id), id_len_off, fw_id, \
+     offsetof(emi_type, emi_cfg.m_dram_rank_size), sizeof(((emi_type*)0)->emi_cfg.m_dram_rank_size[0]), combo}
+
+//!sizing only: large enough to hold any EMIInfoVxx record.
+typedef union MTKEMIRecord
+{
+    EMIInfoV08 emi_v08;
+    EMIInfoV10 emi_v10;
+    EMIInfoV11 emi_v11;
+    EMIInfoV12 emi_v12;
+    EMIInfoV13 emi_v13;
+    EMIInfoV14 emi_v14;
+    EMIInfoV15 emi_v15;
+    EMIInfoV16 emi_v16;
+    EMIInfoV17 emi_v17;
+    EMIInfoV18 emi_v18;
+    EMIInfoV19 emi_v19;
+
+    EMIInfoV20 emi_v20;
+    EMIInfoV21 emi_v21;
+    EMIInfoV22 emi_v22;
+    EMIInfoV23 emi_v23;
+
+    EMIInfoV24 emi_v24;
+    EMIInfoV25 emi_v25;
+    EMIInfoV27 emi_v27;
+    EMIInfoV28 emi_v28;
+
+    EMIInfoV30 emi_v30;
+    EMIInfoV31 emi_v31;
+    EMIInfoV32 emi_v32;
+    EMIInfoV35 emi_v35;
+    EMIInfoV36 emi_v36;
+    EMIInfoV38 emi_v38;
+    EMIInfoV39 emi_v39;
+
+    EMIInfoV46 emi_v46;
+    EMIInfoV49 emi_v49;
+    EMIInfoV51 emi_v51;
+
+}MTKEMIRecord;
+
+//!DRAM type codes (emi_cfg.m_type). the underlying type is fixed, codes not listed here stay valid values.
+enum EMIDramType : quint16
+{
+    DRAM_DISCRETE_DDR1 = 0x001,
+    DRAM_DISCRETE_LPDDR2 = 0x002,
+    DRAM_DISCRETE_LPDDR3 = 0x003,
+    DRAM_DISCRETE_PCDDR3 = 0x004,
+    DRAM_MCP_NAND_DDR1 = 0x101,
+    DRAM_MCP_NAND_LPDDR2 = 0x102,
+    DRAM_MCP_NAND_LPDDR3 = 0x103,
+    DRAM_MCP_NAND_PCDDR3 = 0x104,
+    DRAM_MCP_EMMC_DDR1 = 0x201,
+    DRAM_MCP_EMMC_LPDDR2 = 0x202,
+    DRAM_MCP_EMMC_LPDDR3 = 0x203,
+    DRAM_MCP_EMMC_PCDDR3 = 0x204,
+    DRAM_MCP_EMMC_LPDDR4 = 0x205,
+    DRAM_MCP_EMMC_LPDDR4X = 0x206,
+    DRAM_UMCP_EUFS_LPDDR4X = 0x306,
+    DRAM_UMCP_EUFS_LPDDR5 = 0x308,
+};
+
+//! one decoded EMI record, trivially copyable. the text columns are rendered
+//! on demand from it and the MTK_BLOADER_INFO blob, see EMIParser::RenderEMI.
 typedef struct MTKEMIInfo
 {
-    union
-    {
-        EMIInfoV08 emi_v08;
-        EMIInfoV10 emi_v10;
-        EMIInfoV11 emi_v11;
-        EMIInfoV12 emi_v12;
-        EMIInfoV13 emi_v13;
-        EMIInfoV14 emi_v14;
-        EMIInfoV15 emi_v15;
-        EMIInfoV16 emi_v16;
-        EMIInfoV17 emi_v17;
-        EMIInfoV18 emi_v18;
-        EMIInfoV19 emi_v19;
-
-        EMIInfoV20 emi_v20;
-        EMIInfoV21 emi_v21;
-        EMIInfoV22 emi_v22;
-        EMIInfoV23 emi_v23;
-
-        EMIInfoV24 emi_v24;
-        EMIInfoV25 emi_v25;
-        EMIInfoV27 emi_v27;
-        EMIInfoV28 emi_v28;
-
-        EMIInfoV30 emi_v30;
-        EMIInfoV31 emi_v31;
-        EMIInfoV32 emi_v32;
-        EMIInfoV35 emi_v35;
-        EMIInfoV36 emi_v36;
-        EMIInfoV38 emi_v38;
-        EMIInfoV39 emi_v39;
-
-        EMIInfoV46 emi_v46;
-        EMIInfoV49 emi_v49;
-        EMIInfoV51 emi_v51;
-
-    } emi_cfg = {};
-public:
+    quint index{}; //!record number, a whole-file blob can hold more than 64K
+    EMIDramType dram_type{}; //!unknown codes are kept as is
+    quint8 emi_ver{};
+    quint8 id_len{}; //!bytes used in flash_id
+    qlong dram_size{}; //!bytes
+    quint blob_off{}; //!record offset into the blob
+    quint16 cfg_len{}; //!emi_cfg length at blob_off
+    bool is_ufs{};
+    quint8 fw_id_len{}; //!bytes of fw_id the preloader compares too, 0 => none
+    qchar flash_id[0x10]{};
+    qchar fw_id[8]{};
+}MTKEMIInfo;
+//!written raw by EMIResultCache and EMIManifest: a layout change needs their versions bumped.
+static_assert(sizeof(MTKEMIInfo) == 48, "MTKEMIInfo layout changed");
+
+//! text columns of one MTKEMIInfo.
+typedef struct MTKEMIText
+{
     qstr index{};
     qstr flash_id{};
     qstr manufacturer_id{};
@@ -701,7 +773,18 @@ public:
     qstr dram_size{};
     qbyte m_emi_info{};
     qsizetype m_emi_ver{};
-}MTKEMIInfo;
+}MTKEMIText;
+
+//! MTK_BLOADER_INFO header as seen by the parser.
+typedef struct MTKEMIHeader
+{
+    qstr identifier{}; //MTK_BLOADER_INFO_vXX
+    qstr platform{};
+    qstr flash_dev{};
+    qstr project_id{};
+    quint num_records{};
+    qsizetype emi_ver{};
+}MTKEMIHeader;
 
 typedef struct
 {
@@ -723,6 +806,9 @@ typedef struct
 } gfh_info_t;
 }
 
+Q_STATIC_ASSERT(std::is_trivially_copyable<mtkPreloader::MTKEMIInfo>::value);
+Q_DECLARE_TYPEINFO(mtkPreloader::MTKEMIInfo, Q_PRIMITIVE_TYPE);
+
 namespace mmcCARD {
 
 typedef struct emmc_card_info_cid_t
@@ -746,6 +832,20 @@ public:
     qchar crc7{0x00}; /* CRC7 + stuff bit*/  //--Only top 7 bit
 }mmc_cid_t;
 
+//! decoded CID, fixed size and heap free; RenderCID turns it into CIDInfo text.
+typedef struct CIDData
+{
+    bool is_ufs{0};
+    qchar mid{0x00}; //!eMMC MID
+    qchar cbx{0x00}; //!eMMC Card/BGA
+    quint16 oid{0x00}; //!eMMC OID / first two bytes of the UFS id
+    qchar ufs_vendor{0x00}; //!1 + index into the UFS vendor table, 0 = unknown
+    qchar prv{0x00}; //!eMMC PRV
+    qchar mdt{0x00}; //!eMMC MDT
+    qchar psn[4]{0x00}; //!eMMC PSN
+    char pnm[0x11]{0x00}; //!eMMC PNM / UFS product name, NUL terminated
+}CIDData;
+
 typedef struct CIDInfo
 {
     qstr ManufacturerId{};
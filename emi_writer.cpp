@@ -0,0 +1,289 @@
+#include "emi_writer.h"
+
+EMIWriter *EMIWriter::Create(const qstr &format)
+{
+    if (format == "text")
+        return new EMITextWriter();
+    if (format == "jsonl" || format == "json")
+        return new EMIJsonWriter();
+    if (format == "csv")
+        return new EMICsvWriter();
+    if (format == "binary" || format == "bin")
+        return new EMIBinaryWriter();
+    return nullptr;
+}
+
+static inline void put_line(qbyte &out, const qstr &line)
+{
+    out.append(line.toUtf8());
+    out.append('\n');
+}
+
+void EMITextWriter::Format(const EMIScanResult &result, qbyte &out) const
+{
+    put_line(out, ".....................................................");
+    put_line(out, qstr("Reading emi file %0").arg(result.path));
+
+    for (const qstr &msg : result.messages)
+        put_line(out, msg);
+
+    mtkPreloader::MTKEMIText emi = {};
+    for (const mtkPreloader::MTKEMIInfo &emi_info : result.emis)
+    {
+        EMIParser::RenderEMI(emi_info, result.blob, emi);
+        put_line(out, qstr("EMIInfo{%0}:%1:%2:%3:%4:%5:%6:DRAM:%7:%8").arg(emi.index,
+                                                                           emi.flash_id,
+                                                                           emi.manufacturer_id,
+                                                                           emi.manufacturer,
+                                                                           emi.ProductName,
+                                                                           emi.OEMApplicationId,
+                                                                           emi.CardBGA,
+                                                                           emi.dram_type,
+                                                                           emi.dram_size));
+
+        put_line(out, qstr("EMIInfo{%0}:version:%1:emi_content:%2").arg(emi.index, qstr::number(emi.m_emi_ver), emi.m_emi_info.toHex().data()));
+    }
+}
+
+//!json
+static void put_json_str(qbyte &out, const qstr &str)
+{
+    static const char hex[] = "0123456789abcdef";
+    const qbyte utf8 = str.toUtf8();
+
+    out.append('"');
+    for (qsizetype i = 0; i < utf8.size(); i++)
+    {
+        qchar c = utf8.at(i);
+        switch (c)
+        {
+        case '"': out.append("\\\""); break;
+        case '\\': out.append("\\\\"); break;
+        case '\n': out.append("\\n"); break;
+        case '\r': out.append("\\r"); break;
+        case '\t': out.append("\\t"); break;
+        default:
+            if (c < 0x20)
+            {
+                char esc[] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xf]};
+                out.append(esc, sizeof(esc));
+            }
+            else
+            {
+                out.append((char)c);
+            }
+        }
+    }
+    out.append('"');
+}
+
+static inline void put_json_key(qbyte &out, const char *key, bool first = 0)
+{
+    if (!first)
+        out.append(',');
+    out.append('"').append(key).append("\":");
+}
+
+void EMIJsonWriter::Format(const EMIScanResult &result, qbyte &out) const
+{
+    out.append('{');
+    put_json_key(out, "path", 1);
+    put_json_str(out, result.path);
+    put_json_key(out, "identifier");
+    put_json_str(out, result.header.identifier);
+    put_json_key(out, "emi_ver");
+    out.append(qbyte::number(result.header.emi_ver));
+    put_json_key(out, "platform");
+    put_json_str(out, result.header.platform);
+    put_json_key(out, "flash_dev");
+    put_json_str(out, result.header.flash_dev);
+    put_json_key(out, "project_id");
+    put_json_str(out, result.header.project_id);
+    put_json_key(out, "num_records");
+    out.append(qbyte::number(result.header.num_records));
+
+    put_json_key(out, "messages");
+    out.append('[');
+    for (qsizetype i = 0; i < result.messages.size(); i++)
+    {
+        if (i)
+            out.append(',');
+        put_json_str(out, result.messages.at(i));
+    }
+    out.append(']');
+
+    put_json_key(out, "emis");
+    out.append('[');
+    mtkPreloader::MTKEMIText emi = {};
+    for (qsizetype i = 0; i < result.emis.size(); i++)
+    {
+        EMIParser::RenderEMI(result.emis.at(i), result.blob, emi);
+        if (i)
+            out.append(',');
+
+        out.append('{');
+        put_json_key(out, "index", 1);
+        put_json_str(out, emi.index);
+        put_json_key(out, "flash_id");
+        put_json_str(out, emi.flash_id);
+        put_json_key(out, "manufacturer_id");
+        put_json_str(out, emi.manufacturer_id);
+        put_json_key(out, "manufacturer");
+        put_json_str(out, emi.manufacturer);
+        put_json_key(out, "product_name");
+        put_json_str(out, emi.ProductName);
+        put_json_key(out, "oem_id");
+        put_json_str(out, emi.OEMApplicationId);
+        put_json_key(out, "card_bga");
+        put_json_str(out, emi.CardBGA);
+        put_json_key(out, "dram_type");
+        put_json_str(out, emi.dram_type);
+        put_json_key(out, "dram_size");
+        put_json_str(out, emi.dram_size);
+        put_json_key(out, "emi_info");
+        out.append('"').append(emi.m_emi_info.toHex()).append('"');
+        out.append('}');
+    }
+    out.append(']');
+    out.append("}\n");
+}
+
+//!csv, rfc4180 quoting
+static void put_csv_field(qbyte &out, const qstr &field, bool first = 0)
+{
+    if (!first)
+        out.append(',');
+
+    const qbyte utf8 = field.toUtf8();
+    bool quote = 0;
+    for (qsizetype i = 0; i < utf8.size() && !quote; i++)
+        quote = (utf8.at(i) == ',' || utf8.at(i) == '"' || utf8.at(i) == '\n' || utf8.at(i) == '\r');
+
+    if (!quote)
+    {
+        out.append(utf8);
+        return;
+    }
+
+    out.append('"');
+    for (qsizetype i = 0; i < utf8.size(); i++)
+    {
+        if (utf8.at(i) == '"')
+            out.append('"');
+        out.append(utf8.at(i));
+    }
+    out.append('"');
+}
+
+qbyte EMICsvWriter::Header() const
+{
+    return qbyte("path,identifier,emi_ver,platform,flash_dev,project_id,num_records,"
+                 "index,flash_id,manufacturer_id,manufacturer,product_name,oem_id,card_bga,"
+                 "dram_type,dram_size,emi_info\n");
+}
+
+void EMICsvWriter::Format(const EMIScanResult &result, qbyte &out) const
+{
+    qsizetype rows = qMax<qsizetype>(result.emis.size(), 1);
+    mtkPreloader::MTKEMIText emi = {};
+    for (qsizetype i = 0; i < rows; i++)
+    {
+        put_csv_field(out, result.path, 1);
+        put_csv_field(out, result.header.identifier);
+        put_csv_field(out, qstr::number(result.header.emi_ver));
+        put_csv_field(out, result.header.platform);
+        put_csv_field(out, result.header.flash_dev);
+        put_csv_field(out, result.header.project_id);
+        put_csv_field(out, qstr::number(result.header.num_records));
+
+        if (i < result.emis.size())
+        {
+            EMIParser::RenderEMI(result.emis.at(i), result.blob, emi);
+            put_csv_field(out, emi.index);
+            put_csv_field(out, emi.flash_id);
+            put_csv_field(out, emi.manufacturer_id);
+            put_csv_field(out, emi.manufacturer);
+            put_csv_field(out, emi.ProductName);
+            put_csv_field(out, emi.OEMApplicationId);
+            put_csv_field(out, emi.CardBGA);
+            put_csv_field(out, emi.dram_type);
+            put_csv_field(out, emi.dram_size);
+            put_csv_field(out, emi.m_emi_info.toHex());
+        }
+        else
+        {
+            out.append(",,,,,,,,,,");
+        }
+        out.append('\n');
+    }
+}
+
+//!binary
+template <typename T>
+static inline void put_le(qbyte &out, T val)
+{
+    out.append((const char*)&val, sizeof(T)); //!x86/arm hosts are little endian.
+}
+
+static inline void put_bytes(qbyte &out, const qbyte &bytes)
+{
+    quint16 len = qMin<qsizetype>(bytes.size(), 0xffff);
+    put_le<quint16>(out, len);
+    out.append(bytes.constData(), len);
+}
+
+static inline void put_str(qbyte &out, const qstr &str)
+{
+    put_bytes(out, str.toUtf8());
+}
+
+qbyte EMIBinaryWriter::Header() const
+{
+    qbyte hdr("EMIB");
+    put_le<quint8>(hdr, 4); //!3: u32 message and record counts, 4: u32 record index
+    return hdr;
+}
+
+void EMIBinaryWriter::Format(const EMIScanResult &result, qbyte &out) const
+{
+    qsizetype frame_off = out.size();
+    put_le<quint>(out, 0); //!patched below
+
+    put_str(out, result.path);
+    put_le<quint8>(out, result.header.emi_ver);
+    put_str(out, result.header.identifier);
+    put_str(out, result.header.platform);
+    put_str(out, result.header.flash_dev);
+    put_str(out, result.header.project_id);
+    put_le<quint>(out, result.header.num_records);
+
+    put_le<quint>(out, result.messages.size());
+    for (const qstr &msg : result.messages)
+        put_str(out, msg);
+
+    put_le<quint>(out, result.emis.size()); //!a whole-file blob holds more than 64K records
+    mmcCARD::CIDData cid_data = {};
+    mmcCARD::CIDInfo cid = {};
+    for (const mtkPreloader::MTKEMIInfo &emi : result.emis)
+    {
+        qbyte flash_id = qbyte::fromRawData((const char*)emi.flash_id, emi.id_len);
+        EMIParser::DecodeCID(emi.flash_id, emi.id_len, emi.is_ufs, cid_data);
+        EMIParser::RenderCID(cid_data, cid);
+
+        put_le<quint>(out, emi.index);
+        put_le<quint8>(out, emi.emi_ver);
+        put_le<quint8>(out, emi.is_ufs);
+        put_le<quint16>(out, emi.dram_type);
+        put_le<qlong>(out, emi.dram_size);
+        put_bytes(out, flash_id);
+        put_str(out, cid.ManufacturerId);
+        put_str(out, cid.Manufacturer);
+        put_str(out, cid.ProductName);
+        put_str(out, cid.OEMApplicationId);
+        put_str(out, cid.CardBGA);
+        put_bytes(out, result.blob.mid(emi.blob_off, emi.cfg_len));
+    }
+
+    quint frame_len = out.size() - frame_off - sizeof(quint);
+    memcpy(out.data() + frame_off, &frame_len, sizeof(quint));
+}
@@ -0,0 +1,58 @@
+#ifndef EMI_WRITER_H
+#define EMI_WRITER_H
+
+#include "emi_batch.h"
+
+//! result formatters, Format() is const & reentrant so every worker thread
+//! renders into its own buffer and only raw bytes reach the output device.
+class EMIWriter
+{
+public:
+    EMIWriter(){}
+    virtual ~EMIWriter(){};
+
+    //!text, jsonl, csv, binary; nullptr for anything else.
+    static EMIWriter *Create(const qstr &format);
+
+    virtual qbyte Header() const { return qbyte(); }
+    virtual void Format(const EMIScanResult &result, qbyte &out) const = 0;
+};
+
+//! the classic console layout (same lines qInfo used to print).
+class EMITextWriter : public EMIWriter
+{
+public:
+    void Format(const EMIScanResult &result, qbyte &out) const override;
+};
+
+//! one json object per input file and line.
+class EMIJsonWriter : public EMIWriter
+{
+public:
+    void Format(const EMIScanResult &result, qbyte &out) const override;
+};
+
+//! one row per emi record, files without records get one row with empty record columns.
+class EMICsvWriter : public EMIWriter
+{
+public:
+    qbyte Header() const override;
+    void Format(const EMIScanResult &result, qbyte &out) const override;
+};
+
+//! little endian, length prefixed frames:
+//!  header : "EMIB" u8:version(4)
+//!  file   : u32:frame_len str:path u8:emi_ver str:identifier str:platform str:flash_dev
+//!           str:project_id u32:num_records u32:num_messages str[] u32:num_emis emi[]
+//!  emi    : u32:index u8:emi_ver u8:is_ufs u16:dram_type u64:dram_size(bytes) bytes:flash_id
+//!           str:manufacturer_id str:manufacturer str:product_name str:oem_id str:card_bga
+//!           bytes:emi_info (may be shorter than the record when the blob is truncated)
+//!  str    = u16:len utf8[len], bytes = u16:len raw[len]
+class EMIBinaryWriter : public EMIWriter
+{
+public:
+    qbyte Header() const override;
+    void Format(const EMIScanResult &result, qbyte &out) const override;
+};
+
+#endif // EMI_WRITER_H
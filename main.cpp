@@ -5,69 +5,394 @@
 #include <QSpecialInteger>
 
 #include <preloader_parser.h>
+#include <emi_batch.h>
+#include <emi_sink.h>
+#include <emi_cache.h>
+#include <emi_blockdev.h>
+#include <emi_writer.h>
+#include <emi_daemon.h>
+#include <emi_index.h>
+#include <emi_match.h>
+#include <emi_manifest.h>
 #include <iostream>
+#include <string>
+#include <csignal>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#define emi_isatty(fd) _isatty(fd)
+#else
+#include <unistd.h>
+#define emi_isatty(fd) isatty(fd)
+#endif
+
+//!process exit codes, the worst input decides.
+enum EMIExitCode
+{
+    EMI_EXIT_OK = EMI_SCAN_OK, //!every input had emi records
+    EMI_EXIT_NO_EMI = EMI_SCAN_NO_EMI, //!an input was read but holds no (supported) emi info
+    EMI_EXIT_UNREADABLE = EMI_SCAN_UNREADABLE, //!an input could not be opened
+    EMI_EXIT_USAGE = 3, //!bad arguments, output, cache or socket
+};
+
+static EMIDaemon *emi_daemon = nullptr;
+
+static void stop_daemon(int)
+{
+    if (emi_daemon)
+        emi_daemon->Stop();
+}
+
+static void print_stats(const EMIPipelineStats &stats)
+{
+    double wall_s = stats.wall_ns / 1e9;
+    qInfo().noquote() << qstr("pipeline: %0 ms").arg(wall_s * 1e3, 0, 'f', 1);
+    for (const EMIStageStats &stage : stats.stages)
+    {
+        //!rates per busy thread second, what the stage does when it isn't starved.
+        double busy_s = stage.threads? stage.busy_ns / 1e9 / stage.threads: 0;
+        qInfo().noquote() << qstr("stage{%0}: %1 threads, %2 items, %3 MB, busy %4%, %5 items/s, %6 MB/s")
+                             .arg(stage.name)
+                             .arg(stage.threads)
+                             .arg(stage.items)
+                             .arg(stage.bytes / 1048576.0, 0, 'f', 1)
+                             .arg(wall_s > 0? busy_s / wall_s * 100: 0, 0, 'f', 1)
+                             .arg(busy_s > 0? stage.items / busy_s: 0, 0, 'f', 0)
+                             .arg(busy_s > 0? stage.bytes / 1048576.0 / busy_s: 0, 0, 'f', 1);
+    }
+    for (const EMIQueueStats &queue : stats.queues)
+    {
+        qInfo().noquote() << qstr("queue{%0}: capacity %1, avg %2, max %3")
+                             .arg(queue.name)
+                             .arg(queue.capacity)
+                             .arg(queue.pushes? (double)queue.occupancy / queue.pushes: 0, 0, 'f', 1)
+                             .arg(queue.max_occupancy);
+    }
+}
+
+//! one index hit per line, the record columns of the text writer plus soc and file.
+static void print_index_hit(QIODevice &out, const EMIIndexHit &hit)
+{
+    mtkPreloader::MTKEMIText emi = {};
+    EMIParser::RenderEMI(hit.emi, qbyte(), emi);
+    out.write(qstr("EMIIndex{%0}:%1:%2:%3:%4:DRAM:%5:%6:%7:%8\n").arg(emi.flash_id,
+                                                                      emi.manufacturer_id,
+                                                                      emi.manufacturer,
+                                                                      emi.ProductName,
+                                                                      emi.CardBGA,
+                                                                      emi.dram_type,
+                                                                      emi.dram_size,
+                                                                      hit.soc,
+                                                                      hit.path).toUtf8());
+}
+
+//! the record a preloader boots with on one device, or why there is none.
+static void print_match(QIODevice &out, const EMIScanResult &result, const qstr &dev_id, int pos)
+{
+    if (pos == -1)
+    {
+        out.write(qstr("EMIMatch{%0}:none:%1\n").arg(dev_id, result.path).toUtf8());
+        return;
+    }
+
+    mtkPreloader::MTKEMIText emi = {};
+    EMIParser::RenderEMI(result.emis.at(pos), result.blob, emi);
+    out.write(qstr("EMIMatch{%0}:%1:%2:%3:%4:%5:DRAM:%6:%7:%8\n").arg(dev_id,
+                                                                      emi.index,
+                                                                      emi.flash_id,
+                                                                      emi.manufacturer,
+                                                                      emi.ProductName,
+                                                                      emi.CardBGA,
+                                                                      emi.dram_type,
+                                                                      emi.dram_size,
+                                                                      result.path).toUtf8());
+}
+
+//! newline or NUL (find -print0) separated paths.
+static QStringList read_path_list(QIODevice &list)
+{
+    qbyte data = list.readAll();
+    char sep = data.contains('\0')? '\0': '\n';
+
+    QStringList paths = {};
+    for (qbyte path : data.split(sep))
+    {
+        if (sep == '\n' && path.endsWith('\r'))
+            path.chop(1);
+        if (!path.isEmpty())
+            paths << QFile::decodeName(path);
+    }
+    return paths;
+}
 
 int main(int argc, char *argv[])
 {
+    QCoreApplication::setApplicationName("MTK Preloader Parser V4.0000.0");
+    QCoreApplication::setApplicationVersion("4.0000.0");
+    QCoreApplication::setOrganizationName("Mediatek");
+    //!never exec()'d, QCommandLineParser's help text takes the executable name from it.
     QCoreApplication a(argc, argv);
 
-    a.isSetuidAllowed();
-    a.setApplicationName("MTK Preloader Parser V4.0000.0");
-    a.setApplicationVersion("4.0000.0");
-    a.setOrganizationName("Mediatek");
-    a.setQuitLockEnabled(0);
+    QStringList args = a.arguments();
 
     qInfo("................ MTK Preloader Parser ...............");
     qInfo(".....................................................");
 
-    if(argc < 2)
-        qInfo("Drag and drop the preloader/boot_region file here0!");
+    QCommandLineParser cmd;
+    cmd.setApplicationDescription("exit codes: 0 ok, 1 no emi info in an input (with --match: no record for the device), 2 unreadable input, 3 usage.");
+    cmd.addPositionalArgument("paths", "preloader/boot_region files, block devices, directories or globs.", "[paths...]");
+    QCommandLineOption help_opt = cmd.addHelpOption();
+    QCommandLineOption version_opt = cmd.addVersionOption();
+    QCommandLineOption jobs_opt(QStringList() << "j" << "jobs", "number of parser threads.", "n", "0");
+    QCommandLineOption blobs_opt(QStringList() << "x" << "extract-blobs", "save each distinct MTK_BLOADER_INFO blob into dir.", "dir");
+    QCommandLineOption format_opt(QStringList() << "f" << "format", "output format: text, jsonl, csv or binary.", "format", "text");
+    QCommandLineOption output_opt(QStringList() << "o" << "output", "write results to file instead of stdout.", "file");
+    QCommandLineOption cache_opt(QStringList() << "c" << "cache", "reuse decoded records of already seen MTK_BLOADER_INFO blobs.", "file");
+    QCommandLineOption direct_opt(QStringList() << "direct", "read inputs with O_DIRECT, block devices always are.");
+    QCommandLineOption stdin_list_opt(QStringList() << "stdin-list", "read newline or NUL separated paths from stdin.");
+    QCommandLineOption serve_opt(QStringList() << "serve", "stay resident and answer parse requests on a unix socket.", "socket");
+    QCommandLineOption stats_opt(QStringList() << "stats", "print per stage throughput and queue occupancy of the batch scan.");
+    QCommandLineOption queue_opt(QStringList() << "queue-depth", "max requests parsing or waiting in --serve mode.", "n", "0");
+    QCommandLineOption index_opt(QStringList() << "index", "build a flash id index of the inputs, or the one --query reads.", "file");
+    QCommandLineOption query_opt(QStringList() << "query", "list the indexed records whose flash id starts with this hex prefix.", "hex");
+    QCommandLineOption dram_opt(QStringList() << "dram-size", "only --query records of this dram size.", "MB", "0");
+    QCommandLineOption match_opt(QStringList() << "match", "print the record each input preloader boots with on this eMMC CID / UFS id (repeatable).", "hex");
+    QCommandLineOption ufs_opt(QStringList() << "ufs", "the --match ids are UFS ids.");
+    QCommandLineOption manifest_opt(QStringList() << "m" << "manifest", "only parse inputs that are new or changed since the run that wrote this file.", "file");
+    QCommandLineOption fw_opt(QStringList() << "fw-id", "device firmware id for records with a fw_id_length.", "hex");
+    cmd.addOption(jobs_opt);
+    cmd.addOption(blobs_opt);
+    cmd.addOption(format_opt);
+    cmd.addOption(output_opt);
+    cmd.addOption(cache_opt);
+    cmd.addOption(direct_opt);
+    cmd.addOption(stdin_list_opt);
+    cmd.addOption(stats_opt);
+    cmd.addOption(serve_opt);
+    cmd.addOption(queue_opt);
+    cmd.addOption(index_opt);
+    cmd.addOption(query_opt);
+    cmd.addOption(dram_opt);
+    cmd.addOption(match_opt);
+    cmd.addOption(ufs_opt);
+    cmd.addOption(fw_opt);
+    cmd.addOption(manifest_opt);
+
+    if (!cmd.parse(args))
+    {
+        qInfo().noquote() << cmd.errorText();
+        return EMI_EXIT_USAGE;
+    }
+    if (cmd.isSet(help_opt))
+        cmd.showHelp(EMI_EXIT_OK);
+    if (cmd.isSet(version_opt))
+        cmd.showVersion();
+
+    QStringList inputs = cmd.positionalArguments();
+    if (cmd.isSet(stdin_list_opt))
+    {
+        QFile list;
+        list.open(stdin, QIODevice::ReadOnly);
+        inputs << read_path_list(list);
+    }
+
+    //!the old drag and drop prompt, only when a person is there to answer it.
+    bool serve = cmd.isSet(serve_opt);
+    bool query = cmd.isSet(query_opt);
+    if (query && !cmd.isSet(index_opt))
+    {
+        qInfo("--query needs the --index to read.");
+        return EMI_EXIT_USAGE;
+    }
+
+    bool interactive = !serve && !query && inputs.isEmpty() && !cmd.isSet(stdin_list_opt) && emi_isatty(fileno(stdin));
+    if (inputs.isEmpty() && !interactive && !serve && !query)
+    {
+        if (cmd.isSet(stdin_list_opt))
+            return EMI_EXIT_OK;
+
+        qInfo().noquote() << cmd.helpText();
+        return EMI_EXIT_USAGE;
+    }
+
+    QScopedPointer<EMIWriter> writer(EMIWriter::Create(cmd.value(format_opt)));
+    if (!writer)
+    {
+        qInfo().noquote() << qstr("unsupported output format{%0}").arg(cmd.value(format_opt));
+        return EMI_EXIT_USAGE;
+    }
 
-    while (1) {
+    QScopedPointer<EMIBlobSink> blob_sink;
+    if (cmd.isSet(blobs_opt))
+        blob_sink.reset(new EMIBlobSink(cmd.value(blobs_opt)));
 
-        QByteArray path(0xff, Qt::Uninitialized);
-        std::cin.get((char*)path.data(), 0xff);
+    QScopedPointer<EMIResultCache> cache;
+    if (cmd.isSet(cache_opt))
+    {
+        cache.reset(new EMIResultCache(cmd.value(cache_opt)));
+        if (!cache->isOpen())
+            qInfo().noquote() << qstr("unable to open cache{%0}:%1").arg(cmd.value(cache_opt), cache->errorString());
+    }
 
-        qInfo(".....................................................");
-        qInfo().noquote() << QString("Reading emi file %0").arg(path.data());
-        QFile emi_dev(QDir::toNativeSeparators(path));
-        if (!emi_dev.size())
+    EMIBatchScanner scanner(interactive? 1: cmd.value(jobs_opt).toInt());
+    scanner.setBlobSink(blob_sink.data());
+    scanner.setCache(cache.data());
+    scanner.setDirectIO(cmd.isSet(direct_opt));
+    bool match = cmd.isSet(match_opt);
+    scanner.setWriter(match? nullptr: writer.data()); //!match mode prints its own lines.
+
+    if (serve) //!daemon mode: responses go to the socket clients, not to out.
+    {
+        EMIDaemon daemon(scanner, cmd.value(queue_opt).toInt());
+        if (!daemon.Listen(cmd.value(serve_opt)))
         {
-            qInfo().noquote() << QString("please input a valid file!.");
-            std::cin.ignore();
+            qInfo().noquote() << qstr("unable to serve{%0}:%1").arg(cmd.value(serve_opt), daemon.errorString());
+            return EMI_EXIT_USAGE;
         }
 
-        if (emi_dev.open(QIODevice::ReadOnly))
+        emi_daemon = &daemon;
+        signal(SIGINT, stop_daemon);
+        signal(SIGTERM, stop_daemon);
+        qInfo().noquote() << qstr("serving{%0} with %1 parser threads").arg(cmd.value(serve_opt)).arg(scanner.jobs());
+        daemon.Serve();
+        emi_daemon = nullptr;
+
+        qInfo().noquote() << qstr("served %0 requests").arg(daemon.served());
+        return EMI_EXIT_OK;
+    }
+
+    QFile out;
+    bool out_ok = 0;
+    if (cmd.isSet(output_opt))
+    {
+        out.setFileName(cmd.value(output_opt));
+        out_ok = out.open(QIODevice::WriteOnly);
+    }
+    else
+    {
+        out_ok = out.open(stdout, QIODevice::WriteOnly);
+    }
+
+    if (!out_ok)
+    {
+        qInfo().noquote() << qstr("unable to open output{%0}:%1").arg(out.fileName(), out.errorString());
+        return EMI_EXIT_USAGE;
+    }
+    if (query) //!index lookup: no dump is opened.
+    {
+        qbyte prefix = qbyte::fromHex(cmd.value(query_opt).toLatin1());
+        EMIIndex index(cmd.value(index_opt));
+        if (!index.isOpen())
         {
-            QVector<mtkPreloader::MTKEMIInfo> emis = {};
-            EMIParser::PrasePreloader(emi_dev, emis);
-            emi_dev.close();
+            qInfo().noquote() << qstr("unable to open index{%0}:%1").arg(cmd.value(index_opt), index.errorString());
+            return EMI_EXIT_USAGE;
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+        QVector<EMIIndexHit> hits = {};
+        index.Query(prefix, cmd.value(dram_opt).toULongLong() * 1024 * 1024, hits);
+        qint64 query_ns = timer.nsecsElapsed();
+
+        for (const EMIIndexHit &hit : hits)
+            print_index_hit(out, hit);
+        out.close();
+
+        qInfo().noquote() << qstr("index{%0}: %1 of %2 records in %3 us").arg(cmd.value(index_opt))
+                                                                       .arg(hits.size())
+                                                                       .arg(index.entries())
+                                                                       .arg(query_ns / 1e3, 0, 'f', 1);
+        return hits.isEmpty()? EMI_EXIT_NO_EMI: EMI_EXIT_OK;
+    }
+
+    if (!match)
+        out.write(writer->Header());
 
-            qsizetype idx = 0;
-            for (QVector<mtkPreloader::MTKEMIInfo>::iterator it =
-                 emis.begin(); it != emis.end(); it++)
+    QStringList dev_ids = cmd.values(match_opt);
+    bool dev_ufs = cmd.isSet(ufs_opt);
+    qbyte dev_fw_id = qbyte::fromHex(cmd.value(fw_opt).toLatin1());
+
+    QScopedPointer<EMIIndexBuilder> index;
+    if (cmd.isSet(index_opt))
+        index.reset(new EMIIndexBuilder);
+
+    int exit_code = EMI_EXIT_OK;
+    auto on_result = [&](const EMIScanResult &result)
+    {
+        out.write(result.output); //!already formatted by the worker.
+        exit_code = qMax<int>(exit_code, result.status());
+        if (match && result.opened)
+        {
+            EMIMatcher matcher(result.emis);
+            for (const qstr &dev_id : dev_ids)
             {
-                mtkPreloader::MTKEMIInfo emi = *it;
-                qInfo().noquote() << qstr("EMIInfo{%0}:%1:%2:%3:%4:%5:%6:DRAM:%7:%8").arg(emi.index,
-                                                                                          emi.flash_id,
-                                                                                          emi.manufacturer_id,
-                                                                                          emi.manufacturer,
-                                                                                          emi.ProductName,
-                                                                                          emi.OEMApplicationId,
-                                                                                          emi.CardBGA,
-                                                                                          emi.dram_type,
-                                                                                          emi.dram_size);
-
-                qInfo().noquote() << qstr("EMIInfo{%0}:version:%1:emi_content:%2").arg(emi.index, qstr::number(emi.m_emi_ver), emi.m_emi_info.toHex().data());
-                //! see EMIInfoV20
-                idx++;
+                qbyte raw_id = qbyte::fromHex(dev_id.toLatin1());
+                int pos = matcher.Match((const qchar*)raw_id.constData(), raw_id.size(), dev_ufs, dev_fw_id);
+                print_match(out, result, dev_id, pos);
+                if (pos == -1)
+                    exit_code = qMax<int>(exit_code, EMI_EXIT_NO_EMI);
             }
         }
+        if (index)
+            index->Add(result);
+    };
 
-        path.clear();
-        std::cin.ignore();
+    if (!interactive) //!batch mode: dirs/globs/files => parse all & exit.
+    {
+        QStringList files = EMIBatchScanner::ExpandInputs(inputs);
+        if (cmd.isSet(manifest_opt))
+        {
+            EMIManifest manifest(cmd.value(manifest_opt));
+            manifest.Scan(scanner, files, on_result);
+            if (!manifest.Save())
+                qInfo().noquote() << qstr("unable to write manifest{%0}:%1").arg(cmd.value(manifest_opt), manifest.errorString());
+            qInfo().noquote() << qstr("manifest{%0}: %1 parsed, %2 skipped, %3 removed").arg(cmd.value(manifest_opt))
+                                                                                         .arg(manifest.parsed())
+                                                                                         .arg(manifest.skipped())
+                                                                                         .arg(manifest.removed());
+        }
+        else
+        {
+            scanner.Scan(files, on_result);
+        }
+        if (cmd.isSet(stats_opt))
+            print_stats(scanner.stats());
+    }
+    else
+    {
         qInfo("Drag and drop the preloader/boot_region file here!");
+
+        std::string line;
+        while (std::getline(std::cin, line))
+        {
+            qstr path = qstr::fromStdString(line).trimmed();
+            if (path.size() > 1 && path.startsWith('"') && path.endsWith('"')) //!windows quotes dropped paths with spaces.
+                path = path.mid(1, path.size() - 2);
+
+            if (!path.isEmpty())
+            {
+                scanner.Scan(QStringList() << QDir::toNativeSeparators(path), on_result);
+                out.flush();
+            }
+            qInfo("Drag and drop the preloader/boot_region file here!");
+        }
+    }
+
+    out.close();
+
+    if (index)
+    {
+        if (index->Write(cmd.value(index_opt)))
+            qInfo().noquote() << qstr("index{%0}: %1 records").arg(cmd.value(index_opt)).arg(index->entries());
+        else
+            qInfo().noquote() << qstr("unable to write index{%0}:%1").arg(cmd.value(index_opt), index->errorString());
     }
 
-    return a.exec();
+    if (cache)
+        qInfo().noquote() << qstr("cache{%0}: %1 hits, %2 misses (%3%), %4 entries").arg(cmd.value(cache_opt))
+                                                                                 .arg(cache->hits())
+                                                                                 .arg(cache->misses())
+                                                                                 .arg(cache->hitRate() * 100, 0, 'f', 1)
+                                                                                 .arg(cache->entries());
+    return exit_code;
 }
@@ -1,13 +1,198 @@
 #include "preloader_parser.h"
+#include "emi_sink.h"
+#include "emi_cache.h"
+
+//!MTK_BLOADER_INFO_vXX => record layout, see emi_structures.h
+static const mtkPreloader::EMILayout emi_layouts[] =
+{
+    EMI_LAYOUT(0x08, mtkPreloader::EMIInfoV08, m_emmc_id, EMI_NO_ID_LEN, EMI_NO_FW_ID, 0),
+    EMI_LAYOUT(0x0a, mtkPreloader::EMIInfoV10, m_emmc_id, EMI_ID_LEN(mtkPreloader::EMIInfoV10), EMI_FW_ID(mtkPreloader::EMIInfoV10), 0),
+    EMI_LAYOUT(0x0b, mtkPreloader::EMIInfoV11, m_emmc_id, EMI_ID_LEN(mtkPreloader::EMIInfoV11), EMI_NO_FW_ID, 0),
+    EMI_LAYOUT(0x0c, mtkPreloader::EMIInfoV12, m_emmc_id, EMI_ID_LEN(mtkPreloader::EMIInfoV12), EMI_FW_ID(mtkPreloader::EMIInfoV12), 0),
+    EMI_LAYOUT(0x0d, mtkPreloader::EMIInfoV13, m_emmc_id, EMI_ID_LEN(mtkPreloader::EMIInfoV13), EMI_FW_ID(mtkPreloader::EMIInfoV13), 0),
+    EMI_LAYOUT(0x0e, mtkPreloader::EMIInfoV14, m_emmc_id, EMI_NO_ID_LEN, EMI_NO_FW_ID, 0), //combo => (TODO) for NAND type. //gfh_info.flash_dev != 0x5
+    EMI_LAYOUT(0x0f, mtkPreloader::EMIInfoV15, m_emmc_id, EMI_NO_ID_LEN, EMI_NO_FW_ID, 0), //FIX_ME . wired flash id's =>4B 47 FD 77 00 00 00 11 03 84 04 00 B1 53 00 00
+    EMI_LAYOUT(0x10, mtkPreloader::EMIInfoV16, m_emmc_id, EMI_ID_LEN(mtkPreloader::EMIInfoV16), EMI_FW_ID(mtkPreloader::EMIInfoV16), 0),
+    EMI_LAYOUT(0x11, mtkPreloader::EMIInfoV17, m_emmc_id, EMI_ID_LEN(mtkPreloader::EMIInfoV17), EMI_FW_ID(mtkPreloader::EMIInfoV17), 0),
+    EMI_LAYOUT(0x12, mtkPreloader::EMIInfoV18, m_emmc_id, EMI_ID_LEN(mtkPreloader::EMIInfoV18), EMI_FW_ID(mtkPreloader::EMIInfoV18), 0),
+    EMI_LAYOUT(0x13, mtkPreloader::EMIInfoV19, m_emmc_id, EMI_ID_LEN(mtkPreloader::EMIInfoV19), EMI_FW_ID(mtkPreloader::EMIInfoV19), 0),
+    EMI_LAYOUT(0x14, mtkPreloader::EMIInfoV20, m_emmc_id, EMI_ID_LEN(mtkPreloader::EMIInfoV20), EMI_FW_ID(mtkPreloader::EMIInfoV20), 0),
+    EMI_LAYOUT(0x15, mtkPreloader::EMIInfoV21, m_emmc_id, EMI_ID_LEN(mtkPreloader::EMIInfoV21), EMI_FW_ID(mtkPreloader::EMIInfoV21), 0),
+    EMI_LAYOUT(0x16, mtkPreloader::EMIInfoV22, m_emmc_id, EMI_ID_LEN(mtkPreloader::EMIInfoV22), EMI_FW_ID(mtkPreloader::EMIInfoV22), 0),
+    EMI_LAYOUT(0x17, mtkPreloader::EMIInfoV23, m_emmc_id, EMI_ID_LEN(mtkPreloader::EMIInfoV23), EMI_FW_ID(mtkPreloader::EMIInfoV23), 0),
+    EMI_LAYOUT(0x18, mtkPreloader::EMIInfoV24, m_emmc_id, EMI_ID_LEN(mtkPreloader::EMIInfoV24), EMI_FW_ID(mtkPreloader::EMIInfoV24), 0),
+    EMI_LAYOUT(0x19, mtkPreloader::EMIInfoV25, m_emmc_id, EMI_ID_LEN(mtkPreloader::EMIInfoV25), EMI_FW_ID(mtkPreloader::EMIInfoV25), 0),
+    EMI_LAYOUT(0x1b, mtkPreloader::EMIInfoV27, m_emmc_id, EMI_ID_LEN(mtkPreloader::EMIInfoV27), EMI_FW_ID(mtkPreloader::EMIInfoV27), 0),
+    EMI_LAYOUT(0x1c, mtkPreloader::EMIInfoV28, m_emmc_id, EMI_NO_ID_LEN, EMI_NO_FW_ID, 0),
+    EMI_LAYOUT(0x1e, mtkPreloader::EMIInfoV30, m_emmc_id, EMI_ID_LEN(mtkPreloader::EMIInfoV30), EMI_FW_ID(mtkPreloader::EMIInfoV30), 0),
+    EMI_LAYOUT(0x1f, mtkPreloader::EMIInfoV31, m_emmc_id, EMI_ID_LEN(mtkPreloader::EMIInfoV31), EMI_FW_ID(mtkPreloader::EMIInfoV31), 0),
+    EMI_LAYOUT(0x20, mtkPreloader::EMIInfoV32, m_emmc_id, EMI_ID_LEN(mtkPreloader::EMIInfoV32), EMI_FW_ID(mtkPreloader::EMIInfoV32), 0),
+    EMI_LAYOUT(0x23, mtkPreloader::EMIInfoV35, m_emmc_id, EMI_ID_LEN(mtkPreloader::EMIInfoV35), EMI_FW_ID(mtkPreloader::EMIInfoV35), 0),
+    EMI_LAYOUT(0x24, mtkPreloader::EMIInfoV36, m_emmc_id, EMI_ID_LEN(mtkPreloader::EMIInfoV36), EMI_FW_ID(mtkPreloader::EMIInfoV36), 0),
+    EMI_LAYOUT(0x26, mtkPreloader::EMIInfoV38, m_emmc_id, EMI_ID_LEN(mtkPreloader::EMIInfoV38), EMI_FW_ID(mtkPreloader::EMIInfoV38), 0),
+    EMI_LAYOUT(0x27, mtkPreloader::EMIInfoV39, m_emmc_id, EMI_ID_LEN(mtkPreloader::EMIInfoV39), EMI_FW_ID(mtkPreloader::EMIInfoV39), 1), //MTK_BLOADER_INFO_v39 => MTK EMI V2 combo mode. !common.
+    EMI_LAYOUT(0x28, mtkPreloader::EMIInfoV39, m_emmc_id, EMI_ID_LEN(mtkPreloader::EMIInfoV39), EMI_FW_ID(mtkPreloader::EMIInfoV39), 1),
+    EMI_LAYOUT(0x2d, mtkPreloader::EMIInfoV39, m_emmc_id, EMI_ID_LEN(mtkPreloader::EMIInfoV39), EMI_FW_ID(mtkPreloader::EMIInfoV39), 1),
+    EMI_LAYOUT(0x2e, mtkPreloader::EMIInfoV46, m_ufs_id, EMI_ID_LEN(mtkPreloader::EMIInfoV46), EMI_NO_FW_ID, 1),
+    EMI_LAYOUT(0x2f, mtkPreloader::EMIInfoV39, m_emmc_id, EMI_ID_LEN(mtkPreloader::EMIInfoV39), EMI_FW_ID(mtkPreloader::EMIInfoV39), 1),
+    EMI_LAYOUT(0x31, mtkPreloader::EMIInfoV49, m_ufs_id, EMI_ID_LEN(mtkPreloader::EMIInfoV49), EMI_NO_FW_ID, 1), //MTK_BLOADER_INFO_v49 - MTK_BLOADER_INFO_v52 - MTK_BLOADER_INFO_v54
+    EMI_LAYOUT(0x33, mtkPreloader::EMIInfoV51, m_ufs_id, EMI_ID_LEN(mtkPreloader::EMIInfoV51), EMI_FW_ID(mtkPreloader::EMIInfoV51), 1),
+    EMI_LAYOUT(0x34, mtkPreloader::EMIInfoV49, m_ufs_id, EMI_ID_LEN(mtkPreloader::EMIInfoV49), EMI_NO_FW_ID, 1),
+    EMI_LAYOUT(0x36, mtkPreloader::EMIInfoV49, m_ufs_id, EMI_ID_LEN(mtkPreloader::EMIInfoV49), EMI_NO_FW_ID, 1),
+};
+
+//!MTK_BLOADER_INFO_vXX => soc, used when the image itself names none.
+static const struct EMIPlatform
+{
+    quint8 emi_ver;
+    const char *platform;
+} emi_platforms[] =
+{
+    {0, "MT6595/MT6797"},
+    {4, "MT6516"},
+    {7, "MT6573"},
+    {8, "MT6575/MT6577"},
+    {10, "MT6589/MT8135"},
+    {11, "MT6572"},
+    {12, "MT6582"},
+    {13, "MT6592/MT8127"},
+    {20, "MT6735"},
+    {21, "MT6580"},
+    {22, "MT6755"},
+    {25, "MT6757"},
+    {27, "MT6570"},
+    {28, "MT8167"},
+    {30, "MT6763"},
+    {31, "MT6758"},
+    {32, "MT6739"},
+    {35, "MT6765"},
+    {36, "MT6771"},
+    {38, "MT6761"},
+    {39, "MT6779"},
+    {40, "MT6768"},
+    {45, "MT6785"},
+    {46, "MT6883/MT6885/MT6889"},
+    {47, "MT6873/MT6875"},
+    {49, "MT6853"},
+    {51, "MT6893"},
+    {52, "MT6833"},
+    {54, "MT6877"},
+};
+
+//!UFS part number prefix => vendor. sorted and prefix free, at most one entry matches.
+static const struct UFSVendor
+{
+    const char *prefix;
+    quint16 mfr_id; //!JEDEC wManufacturerID, 0 = none on record, ManufacturerId stays empty
+    const char *name;
+} ufs_vendors[] =
+{
+    {"FEMD", 0x000, "Longsys"}, //!FORESEE
+    {"H28U", UFS_VENDOR_SKHYNIX, "SkHynix"},
+    {"H9", UFS_VENDOR_SKHYNIX, "SkHynix"},
+    {"HN8T", UFS_VENDOR_SKHYNIX, "SkHynix"},
+    {"KLU", UFS_VENDOR_SAMSUNG, "Samsung"},
+    {"KM", UFS_VENDOR_SAMSUNG, "Samsung"},
+    {"MT", UFS_VENDOR_MICRON_MP, "Micron"},
+    {"SDIN", UFS_VENDOR_WDC, "WDC"},
+    {"TH", UFS_VENDOR_KIOXIA, "Kioxia"}, //!Toshiba parts of old have the same THG prefix and id
+    {"YMUS", 0x000, "YMTC"},
+    {"Z", UFS_VENDOR_MICRON_ES, "Micron"},
+};
+
+struct MTKBLOADERINFO
+{
+    char m_identifier[0x1b]{0x00};
+    char m_filename[0x3d]{0x00};
+    quint m_version{0x00}; //V116
+    quint m_chksum_seed{0x00}; //22884433
+    quint m_start_addr{0x00}; //90007000
+    char m_bin_identifier[8]{0x00}; //MTK_BIN
+    quint m_num_emi_settings{0x00}; //!# number of emi settings.
+};
+
+template <typename T>
+static inline T get_field(const char *emi_cfg, qsizetype off)
+{
+    T val = 0;
+    memcpy(&val, emi_cfg + off, sizeof(T));
+    return val;
+}
+
+EMIImage::EMIImage(QIODevice &emi_dev) : m_dev(&emi_dev)
+{
+    m_file = qobject_cast<QFileDevice*>(&emi_dev);
+    if (m_file && !m_file->isSequential() && m_file->size() > 0)
+    {
+        m_map_len = qMin<qint64>(m_file->size(), m_limit);
+        m_map = m_file->map(0x00, m_map_len);
+        if (m_map)
+        {
+            m_view = qbyte::fromRawData((char*)m_map, m_map_len);
+            return;
+        }
+    }
+
+    //!not mappable => read as we go.
+    m_eof = !emi_dev.isSequential() && !emi_dev.seek(0x00);
+}
+
+EMIImage::~EMIImage()
+{
+    m_view.clear(); //!drop the raw data before unmapping it.
+    if (m_map)
+        m_file->unmap(m_map);
+}
+
+bool EMIImage::Fill(qint64 len)
+{
+    len = qMin(len, m_limit);
+    while (!m_map && !m_eof && m_view.size() < len)
+    {
+        qsizetype old_len = m_view.size();
+        qsizetype chunk = qMin<qint64>(EMI_READ_CHUNK, m_limit - old_len);
+        m_view.resize(old_len + chunk);
+
+        qint64 read_len = m_dev->read(m_view.data() + old_len, chunk);
+        if (read_len <= 0 && !m_dev->waitForReadyRead(-1))
+            m_eof = 1;
+
+        m_view.resize(old_len + qMax<qint64>(read_len, 0));
+    }
+    return m_view.size() >= len;
+}
+
+void EMIImage::Limit(qint64 len)
+{
+    m_limit = qMin(len, m_limit);
+    if (m_map)
+    {
+        m_view = qbyte::fromRawData((char*)m_map, qMin(m_map_len, m_limit));
+        return;
+    }
+
+    if (m_view.size() > m_limit)
+        m_view.truncate(m_limit);
+    m_view.reserve(qMin<qint64>(m_limit, EMI_MAX_RESERVE));
+}
 
 bool EMIParser::PrasePreloader(QIODevice &emi_dev, QVector<mtkPreloader::MTKEMIInfo> &emis)
 {
-    if (!emi_dev.seek(0x00))
-        return 0;
+    if (Locate(emi_dev))
+        Decode(emis);
+    return 0;
+}
+
+bool EMIParser::Locate(QIODevice &emi_dev)
+{
+    m_layout = nullptr;
+    EMIImage image(emi_dev);
+    const qbyte &emi_buf = image.view();
 
     mtkPreloader::gfh_info_t gfh_info = {};
-    if (!emi_dev.read((char*)&gfh_info, sizeof(gfh_info)))
+    if (!image.Fill(sizeof(gfh_info)))
         return 0;
+    memcpy(&gfh_info, emi_buf.constData(), sizeof(gfh_info));
 
     if (gfh_info.length == 0
             || (gfh_info.magic != 0x14d4d4d //!PRELOADER
@@ -15,41 +200,52 @@ bool EMIParser::PrasePreloader(QIODevice &emi_dev, QVector<mtkPreloader::MTKEMII
                 && gfh_info.magic != 0x434d4d45 //!EMMC_BOOT0
                 && gfh_info.magic != 0x5f534655)) //!UFS_LUN0
     {
-        qInfo().noquote() << qstr("invalid/unsupported mtk_boot_region file format{%0}").arg(get_hex(gfh_info.magic));
+        log(qstr("invalid/unsupported mtk_boot_region file format{%0}").arg(get_hex(gfh_info.magic)));
         return 0;
     }
 
     qint64 emi_idx = 0x00;
-    if (gfh_info.magic == 0x434d4d45
-            || gfh_info.magic == 0x5f534655) //!MTK_BOOT_REGION!
+    bool boot_region = (gfh_info.magic == 0x434d4d45
+                        || gfh_info.magic == 0x5f534655); //!MTK_BOOT_REGION!
+    if (boot_region)
     {
         qsizetype seek_off = (gfh_info.magic == 0x5f534655)?0x1000: 0x800; //UFS_LUN & EMMC_BOOT
-        if (!emi_dev.seek(seek_off))
+        if (!image.Fill(seek_off + sizeof(gfh_info)))
             return 0;
 
-        memset(&gfh_info, 0x00, sizeof(gfh_info));
-        if (!emi_dev.read((char*)&gfh_info, sizeof(gfh_info)))
-            return 0;
+        memcpy(&gfh_info, emi_buf.constData() + seek_off, sizeof(gfh_info));
 
         if (gfh_info.length == 0
                 || gfh_info.magic != 0x14d4d4d) //!MTK_PRELOADER_MAGIC!
         {
-            qInfo().noquote() << qstr("invalid/unsupported mtk_boot_region data{%0}").arg(get_hex(gfh_info.magic));
+            log(qstr("invalid/unsupported mtk_boot_region data{%0}").arg(get_hex(gfh_info.magic)));
             return 0;
         }
 
-        if (!emi_dev.seek(0x00))
-            return 0;
+        //!the rest of the dump is never read, only the preloader and the emi window that may run past its end.
+        image.Limit((qint64)seek_off + gfh_info.length + EMI_MAX_LEN);
+    }
+
+    //!one pass over the image for every anchor, shared with GetEMIFlashDev.
+    //!streamed input is scanned chunk by chunk while it's read.
+    EMIAnchors anchors = {};
+    qsizetype scanned = 0;
+    do
+    {
+        FindEMIAnchors(emi_buf, anchors, scanned);
+        scanned = emi_buf.size();
+        image.Fill(scanned + EMI_READ_CHUNK);
+    } while (emi_buf.size() > scanned);
+    m_scanned = scanned;
 
-        emi_idx = emi_dev.readAll().indexOf(MTK_BLOADER_INFO_BEGIN);
+    if (boot_region)
+    {
+        emi_idx = anchors.bldr_info;
         if (emi_idx == -1)
         {
-            qInfo().noquote() << qstr("invalid/unsupported mtk_boot_region data{%0}").arg(get_hex(gfh_info.magic));
+            log(qstr("invalid/unsupported mtk_boot_region data{%0}").arg(get_hex(gfh_info.magic)));
             return 0;
         }
-
-        if (!emi_dev.seek(0x00))
-            return 0;
     }
 
     qbyte BldrInfo = {};
@@ -58,1036 +254,267 @@ bool EMIParser::PrasePreloader(QIODevice &emi_dev, QVector<mtkPreloader::MTKEMII
 
     if (gfh_info.magic == 0x5f4b544d) //!MTK_BLOADER_INFO!
     {
-        BldrInfo.resize(emi_dev.size());
-
-        if (!emi_dev.seek(0x00))
-            return 0;
-        if (!emi_dev.read(BldrInfo.data(), BldrInfo.size()))
-            return 0;
-
-        platform = GetEMIFlashDev(BldrInfo);
+        BldrInfo = emi_buf;
+        platform = GetEMIFlashDev(BldrInfo, anchors);
     }
     else
     {
         if (gfh_info.length == 0
                 || gfh_info.magic != 0x14d4d4d) //!MTK_PRELOADER_MAGIC!
         {
-            qInfo().noquote() << qstr("invalid/unsupported mtk_boot_region data{%0}").arg(get_hex(gfh_info.magic));
+            log(qstr("invalid/unsupported mtk_boot_region data{%0}").arg(get_hex(gfh_info.magic)));
             return 0;
         }
 
-        if (!emi_dev.seek(0x00))
-            return 0;
-
-        qbyte prl_info = emi_dev.readAll();
-        platform = GetEMIFlashDev(prl_info);
+        platform = GetEMIFlashDev(emi_buf, anchors);
 
-        if (!emi_dev.seek(0x00))
-            return 0;
-
-        quint emilength = 0x1000; //!MAX_EMI_LEN
+        quint emilength = EMI_MAX_LEN;
         quint emi_loc = gfh_info.length - gfh_info.sig_length - sizeof(quint);
 
         if (emi_idx == 0x00)
         {
-            if (!emi_dev.seek(emi_loc))
+            if ((qint64)emi_loc + (qint64)sizeof(quint) > emi_buf.size())
                 return 0;
 
-            if (!emi_dev.read((char*)&emilength, sizeof(quint)))
-                return 0;
+            memcpy(&emilength, emi_buf.constData() + emi_loc, sizeof(quint));
 
             if (emilength == 0)
             {
-                qInfo().noquote() << qstr("invalid/unsupported mtk_bloader_info data{%0}").arg(get_hex(emi_loc));
+                log(qstr("invalid/unsupported mtk_bloader_info data{%0}").arg(get_hex(emi_loc)));
                 return 0;
             }
 
             emi_idx = emi_loc - emilength;
         }
 
-        BldrInfo.resize(emilength);
-        if (!emi_dev.seek(emi_idx))
-            return 0;
-        if (!emi_dev.read(BldrInfo.data(), BldrInfo.size()))
+        if (emi_idx < 0 || emi_idx >= emi_buf.size())
             return 0;
+
+        BldrInfo = qbyte::fromRawData(emi_buf.constData() + emi_idx, qMin<qint64>(emilength, emi_buf.size() - emi_idx));
     }
 
-    struct MTKBLOADERINFO
-    {
-        char m_identifier[0x1b]{0x00};
-        char m_filename[0x3d]{0x00};
-        quint m_version{0x00}; //V116
-        quint m_chksum_seed{0x00}; //22884433
-        quint m_start_addr{0x00}; //90007000
-        char m_bin_identifier[8]{0x00}; //MTK_BIN
-        quint m_num_emi_settings{0x00}; //!# number of emi settings.
-    } bldr = {};
-    memcpy(&bldr, BldrInfo.data(), sizeof(bldr));
+    MTKBLOADERINFO bldr = {};
+    memcpy(&bldr, BldrInfo.constData(), qMin<qsizetype>(sizeof(bldr), BldrInfo.size()));
     qbyte emi_hdr((char*)bldr.m_identifier , sizeof(bldr.m_identifier ));
     qbyte project_id((char*)bldr.m_filename, sizeof(bldr.m_filename));
 
-    qInfo().noquote() << qstr("EMIInfo{%0}:%1:%2:%3:num_records[%4]").arg(emi_hdr.data(),
-                                                                          platform,
-                                                                          flash_dev,
-                                                                          project_id,
-                                                                          get_hex(bldr.m_num_emi_settings));
+    m_header.identifier = emi_hdr.data();
+    m_header.platform = platform;
+    m_header.flash_dev = flash_dev;
+    m_header.project_id = project_id;
+    m_header.num_records = bldr.m_num_emi_settings;
+
+    log(qstr("EMIInfo{%0}:%1:%2:%3:num_records[%4]").arg(m_header.identifier,
+                                                         platform,
+                                                         flash_dev,
+                                                         m_header.project_id,
+                                                         get_hex(bldr.m_num_emi_settings)));
 
     if (!emi_hdr.startsWith(MTK_BLOADER_INFO_BEGIN))
     {
-        qInfo().noquote() << qstr("invalid/unsupported mtk_emi_info{%0}").arg(emi_hdr.data());
+        log(qstr("invalid/unsupported mtk_emi_info{%0}").arg(emi_hdr.data()));
         return 0;
     }
 
-    QFile BLDRINFO(emi_hdr);
-    BLDRINFO.open(QIODevice::WriteOnly);
-    BLDRINFO.write(BldrInfo);
-    BLDRINFO.close();
+    //!already parsed by the anchor scan when the header sits at the anchor.
+    qint16 bldr_ver = anchors.bldr_ver;
+    if (anchors.bldr_info == -1 || BldrInfo.constData() != emi_buf.constData() + anchors.bldr_info)
+        bldr_ver = GetEMIVersion(emi_hdr.constData(), emi_hdr.size());
+    quint8 emi_ver = (bldr_ver == -1)? 0: bldr_ver;
+    m_header.emi_ver = emi_ver;
 
-    emi_hdr.remove(0, 0x12);
-    quint8 emi_ver = emi_hdr.toInt(nullptr, 0xa);
+    if (m_sink) //!MTK_BLOADER_INFO extraction is opt-in.
+        m_sink->Submit(emi_ver, BldrInfo);
 
-    qInfo(".....................................................");
+    log(".....................................................");
 
-    qsizetype idx = sizeof(bldr);
-    for (uint i = 0; i < bldr.m_num_emi_settings; i++)
+    const mtkPreloader::EMILayout *emi_layout = get_emi_layout(emi_ver);
+    if (!emi_layout)
     {
-        mtkPreloader::MTKEMIInfo emi = {};
-        emi.m_emi_ver = emi_ver;
-
-        if (emi_ver == 0x08)
-        {
-            memcpy(&emi.emi_cfg.emi_v08, BldrInfo.mid(idx).data(), sizeof(emi.emi_cfg.emi_v08.emi_cfg));
-            idx += sizeof(emi.emi_cfg.emi_v08.emi_len);
-            if (!emi.emi_cfg.emi_v08.emi_cfg.m_type)
-                continue;
-
-            emi.m_emi_info = (qbyte((char*)&emi.emi_cfg.emi_v08.emi_cfg, sizeof(emi.emi_cfg.emi_v08.emi_cfg))); //fixed_len
-
-            qbyte dev_id = qbyte((char*)emi.emi_cfg.emi_v08.emi_cfg.m_emmc_id, sizeof(emi.emi_cfg.emi_v08.emi_cfg.m_emmc_id));
-//            dev_id.resize(emi.emi_cfg.emi_v08.emi_cfg.m_id_length);
-
-            mmcCARD::CIDInfo m_cid = {};
-            PraseCID(dev_id, m_cid);
-
-            emi.index = get_hex(i);
-            emi.flash_id = dev_id.toHex().data();
-            emi.manufacturer_id = m_cid.ManufacturerId;
-            emi.manufacturer = m_cid.Manufacturer;
-            emi.ProductName = m_cid.ProductName;
-            emi.OEMApplicationId = m_cid.OEMApplicationId;
-            emi.CardBGA = m_cid.CardBGA;
-            emi.dram_type = get_dram_type(emi.emi_cfg.emi_v08.emi_cfg.m_type);
-            emi.dram_size = get_unit(emi.emi_cfg.emi_v08.emi_cfg.m_dram_rank_size[0] +
-                    emi.emi_cfg.emi_v08.emi_cfg.m_dram_rank_size[1] +
-                    emi.emi_cfg.emi_v08.emi_cfg.m_dram_rank_size[2] +
-                    emi.emi_cfg.emi_v08.emi_cfg.m_dram_rank_size[3]);
-        }
-        else if(emi_ver == 0xa)
-        {
-            memcpy(&emi.emi_cfg.emi_v10, BldrInfo.mid(idx).data(), sizeof(emi.emi_cfg.emi_v10.emi_cfg));
-            idx += sizeof(emi.emi_cfg.emi_v10.emi_len);
-            if (!emi.emi_cfg.emi_v10.emi_cfg.m_type)
-                continue;
-
-            emi.m_emi_info = (qbyte((char*)&emi.emi_cfg.emi_v10.emi_cfg, sizeof(emi.emi_cfg.emi_v10.emi_cfg))); //fixed_len
-
-            qbyte dev_id = qbyte((char*)&emi.emi_cfg.emi_v10.emi_cfg.m_emmc_id, sizeof(emi.emi_cfg.emi_v10.emi_cfg.m_emmc_id));
-            dev_id.resize(emi.emi_cfg.emi_v10.emi_cfg.m_id_length);
-
-            mmcCARD::CIDInfo m_cid = {};
-            PraseCID(dev_id, m_cid);
-
-            emi.index = get_hex(i);
-            emi.flash_id = dev_id.toHex().data();
-            emi.manufacturer_id = m_cid.ManufacturerId;
-            emi.manufacturer = m_cid.Manufacturer;
-            emi.ProductName = m_cid.ProductName;
-            emi.OEMApplicationId = m_cid.OEMApplicationId;
-            emi.CardBGA = m_cid.CardBGA;
-            emi.dram_type = get_dram_type(emi.emi_cfg.emi_v10.emi_cfg.m_type);
-            emi.dram_size = get_unit(emi.emi_cfg.emi_v10.emi_cfg.m_dram_rank_size[0] +
-                    emi.emi_cfg.emi_v10.emi_cfg.m_dram_rank_size[1] +
-                    emi.emi_cfg.emi_v10.emi_cfg.m_dram_rank_size[2] +
-                    emi.emi_cfg.emi_v10.emi_cfg.m_dram_rank_size[3]);
-        }
-        else if(emi_ver == 0xb)
-        {
-            memcpy(&emi.emi_cfg.emi_v11, BldrInfo.mid(idx).data(), sizeof(emi.emi_cfg.emi_v11.emi_cfg));
-            idx += sizeof(emi.emi_cfg.emi_v11.emi_len);
-            if (!emi.emi_cfg.emi_v11.emi_cfg.m_type)
-                continue;
-
-            emi.m_emi_info = (qbyte((char*)&emi.emi_cfg.emi_v11.emi_cfg, sizeof(emi.emi_cfg.emi_v11.emi_cfg))); //fixed_len
-
-            qbyte dev_id = qbyte((char*)&emi.emi_cfg.emi_v11.emi_cfg.m_emmc_id, sizeof(emi.emi_cfg.emi_v11.emi_cfg.m_emmc_id));
-            dev_id.resize(emi.emi_cfg.emi_v11.emi_cfg.m_id_length);
-
-            mmcCARD::CIDInfo m_cid = {};
-            PraseCID(dev_id, m_cid);
-
-            emi.index = get_hex(i);
-            emi.flash_id = dev_id.toHex().data();
-            emi.manufacturer_id = m_cid.ManufacturerId;
-            emi.manufacturer = m_cid.Manufacturer;
-            emi.ProductName = m_cid.ProductName;
-            emi.OEMApplicationId = m_cid.OEMApplicationId;
-            emi.CardBGA = m_cid.CardBGA;
-            emi.dram_type = get_dram_type(emi.emi_cfg.emi_v11.emi_cfg.m_type);
-            emi.dram_size = get_unit(emi.emi_cfg.emi_v11.emi_cfg.m_dram_rank_size[0] +
-                    emi.emi_cfg.emi_v11.emi_cfg.m_dram_rank_size[1] +
-                    emi.emi_cfg.emi_v11.emi_cfg.m_dram_rank_size[2] +
-                    emi.emi_cfg.emi_v11.emi_cfg.m_dram_rank_size[3]);
-        }
-        else if(emi_ver == 0xc)
-        {
-            memcpy(&emi.emi_cfg.emi_v12, BldrInfo.mid(idx).data(), sizeof(emi.emi_cfg.emi_v12.emi_cfg));
-            idx += sizeof(emi.emi_cfg.emi_v12.emi_len);
-            if (!emi.emi_cfg.emi_v12.emi_cfg.m_type)
-                continue;
-
-            emi.m_emi_info = (qbyte((char*)&emi.emi_cfg.emi_v12.emi_cfg, sizeof(emi.emi_cfg.emi_v12.emi_cfg))); //fixed_len
-
-            qbyte dev_id = qbyte((char*)&emi.emi_cfg.emi_v12.emi_cfg.m_emmc_id, sizeof(emi.emi_cfg.emi_v12.emi_cfg.m_emmc_id));
-            dev_id.resize(emi.emi_cfg.emi_v12.emi_cfg.m_id_length);
-
-            mmcCARD::CIDInfo m_cid = {};
-            PraseCID(dev_id, m_cid);
-
-            emi.index = get_hex(i);
-            emi.flash_id = dev_id.toHex().data();
-            emi.manufacturer_id = m_cid.ManufacturerId;
-            emi.manufacturer = m_cid.Manufacturer;
-            emi.ProductName = m_cid.ProductName;
-            emi.OEMApplicationId = m_cid.OEMApplicationId;
-            emi.CardBGA = m_cid.CardBGA;
-            emi.dram_type = get_dram_type(emi.emi_cfg.emi_v12.emi_cfg.m_type);
-            emi.dram_size = get_unit(emi.emi_cfg.emi_v12.emi_cfg.m_dram_rank_size[0] +
-                    emi.emi_cfg.emi_v12.emi_cfg.m_dram_rank_size[1] +
-                    emi.emi_cfg.emi_v12.emi_cfg.m_dram_rank_size[2] +
-                    emi.emi_cfg.emi_v12.emi_cfg.m_dram_rank_size[3]);
-        }
-        else if(emi_ver == 0xd)
-        {
-            memcpy(&emi.emi_cfg.emi_v13, BldrInfo.mid(idx).data(), sizeof(emi.emi_cfg.emi_v13.emi_cfg));
-            idx += sizeof(emi.emi_cfg.emi_v13.emi_len);
-            if (!emi.emi_cfg.emi_v13.emi_cfg.m_type)
-                continue;
-
-            emi.m_emi_info = (qbyte((char*)&emi.emi_cfg.emi_v13.emi_cfg, sizeof(emi.emi_cfg.emi_v13.emi_cfg))); //fixed_len
-
-            qbyte dev_id = qbyte((char*)&emi.emi_cfg.emi_v13.emi_cfg.m_emmc_id, sizeof(emi.emi_cfg.emi_v13.emi_cfg.m_emmc_id));
-            dev_id.resize(emi.emi_cfg.emi_v13.emi_cfg.m_id_length);
-
-            mmcCARD::CIDInfo m_cid = {};
-            PraseCID(dev_id, m_cid);
-
-            emi.index = get_hex(i);
-            emi.flash_id = dev_id.toHex().data();
-            emi.manufacturer_id = m_cid.ManufacturerId;
-            emi.manufacturer = m_cid.Manufacturer;
-            emi.ProductName = m_cid.ProductName;
-            emi.OEMApplicationId = m_cid.OEMApplicationId;
-            emi.CardBGA = m_cid.CardBGA;
-            emi.dram_type = get_dram_type(emi.emi_cfg.emi_v13.emi_cfg.m_type);
-            emi.dram_size = get_unit(emi.emi_cfg.emi_v13.emi_cfg.m_dram_rank_size[0] +
-                    emi.emi_cfg.emi_v13.emi_cfg.m_dram_rank_size[1] +
-                    emi.emi_cfg.emi_v13.emi_cfg.m_dram_rank_size[2] +
-                    emi.emi_cfg.emi_v13.emi_cfg.m_dram_rank_size[3]);
-        }
-        else if(emi_ver == 0xe) //combo => (TODO) for NAND type. //gfh_info.flash_dev != 0x5
-        {
-            memcpy(&emi.emi_cfg.emi_v14, BldrInfo.mid(idx).data(), sizeof(emi.emi_cfg.emi_v14.emi_cfg));
-            idx += sizeof(emi.emi_cfg.emi_v14.emi_len);
-            if (!emi.emi_cfg.emi_v14.emi_cfg.m_type)
-                continue;
-
-            emi.m_emi_info = (qbyte((char*)&emi.emi_cfg.emi_v14.emi_cfg, sizeof(emi.emi_cfg.emi_v14.emi_cfg))); //fixed_len
-
-            qbyte dev_id = qbyte((char*)&emi.emi_cfg.emi_v14.emi_cfg.m_emmc_id, sizeof(emi.emi_cfg.emi_v14.emi_cfg.m_emmc_id));
-            //dev_id.resize(emi.emi_cfg.emi_v14.emi_cfg.m_id_length);
-
-            mmcCARD::CIDInfo m_cid = {};
-            PraseCID(dev_id, m_cid);
-
-            emi.index = get_hex(i);
-            emi.flash_id = dev_id.toHex().data();
-            emi.manufacturer_id = m_cid.ManufacturerId;
-            emi.manufacturer = m_cid.Manufacturer;
-            emi.ProductName = m_cid.ProductName;
-            emi.OEMApplicationId = m_cid.OEMApplicationId;
-            emi.CardBGA = m_cid.CardBGA;
-            emi.dram_type = get_dram_type(emi.emi_cfg.emi_v14.emi_cfg.m_type);
-            emi.dram_size = get_unit(emi.emi_cfg.emi_v14.emi_cfg.m_dram_rank_size[0] +
-                    emi.emi_cfg.emi_v14.emi_cfg.m_dram_rank_size[1] +
-                    emi.emi_cfg.emi_v14.emi_cfg.m_dram_rank_size[2] +
-                    emi.emi_cfg.emi_v14.emi_cfg.m_dram_rank_size[3]);
-        }
-        else if(emi_ver == 0xf) //FIX_ME . wired flash id's =>4B 47 FD 77 00 00 00 11 03 84 04 00 B1 53 00 00
-        {
-            memcpy(&emi.emi_cfg.emi_v15, BldrInfo.mid(idx).data(), sizeof(emi.emi_cfg.emi_v15.emi_cfg));
-            idx += sizeof(emi.emi_cfg.emi_v15.emi_len);
-            if (!emi.emi_cfg.emi_v15.emi_cfg.m_type)
-                continue;
-
-            emi.m_emi_info = (qbyte((char*)&emi.emi_cfg.emi_v15.emi_cfg, sizeof(emi.emi_cfg.emi_v15.emi_cfg))); //fixed_len
-
-            qbyte dev_id = qbyte((char*)&emi.emi_cfg.emi_v15.emi_cfg.m_emmc_id, sizeof(emi.emi_cfg.emi_v15.emi_cfg.m_emmc_id));
-            //dev_id.resize(emi.emi_cfg.emi_v15.emi_cfg.m_id_length);
-
-            mmcCARD::CIDInfo m_cid = {};
-            PraseCID(dev_id, m_cid);
-
-            emi.index = get_hex(i);
-            emi.flash_id = dev_id.toHex().data();
-            emi.manufacturer_id = m_cid.ManufacturerId;
-            emi.manufacturer = m_cid.Manufacturer;
-            emi.ProductName = m_cid.ProductName;
-            emi.OEMApplicationId = m_cid.OEMApplicationId;
-            emi.CardBGA = m_cid.CardBGA;
-            emi.dram_type = get_dram_type(emi.emi_cfg.emi_v15.emi_cfg.m_type);
-            emi.dram_size = get_unit(emi.emi_cfg.emi_v15.emi_cfg.m_dram_rank_size[0] +
-                    emi.emi_cfg.emi_v15.emi_cfg.m_dram_rank_size[1] +
-                    emi.emi_cfg.emi_v15.emi_cfg.m_dram_rank_size[2] +
-                    emi.emi_cfg.emi_v15.emi_cfg.m_dram_rank_size[3]);
-        }
-        else if(emi_ver == 0x10)
-        {
-            memcpy(&emi.emi_cfg.emi_v16, BldrInfo.mid(idx).data(), sizeof(emi.emi_cfg.emi_v16.emi_cfg));
-            idx += sizeof(emi.emi_cfg.emi_v16.emi_len);
-            if (!emi.emi_cfg.emi_v16.emi_cfg.m_type)
-                continue;
-
-            emi.m_emi_info = (qbyte((char*)&emi.emi_cfg.emi_v16.emi_cfg, sizeof(emi.emi_cfg.emi_v16.emi_cfg))); //fixed_len
-
-            qbyte dev_id = qbyte((char*)&emi.emi_cfg.emi_v16.emi_cfg.m_emmc_id, sizeof(emi.emi_cfg.emi_v16.emi_cfg.m_emmc_id));
-            dev_id.resize(emi.emi_cfg.emi_v16.emi_cfg.m_id_length);
-
-            mmcCARD::CIDInfo m_cid = {};
-            PraseCID(dev_id, m_cid);
-
-            emi.index = get_hex(i);
-            emi.flash_id = dev_id.toHex().data();
-            emi.manufacturer_id = m_cid.ManufacturerId;
-            emi.manufacturer = m_cid.Manufacturer;
-            emi.ProductName = m_cid.ProductName;
-            emi.OEMApplicationId = m_cid.OEMApplicationId;
-            emi.CardBGA = m_cid.CardBGA;
-            emi.dram_type = get_dram_type(emi.emi_cfg.emi_v16.emi_cfg.m_type);
-            emi.dram_size = get_unit(emi.emi_cfg.emi_v16.emi_cfg.m_dram_rank_size[0] +
-                    emi.emi_cfg.emi_v16.emi_cfg.m_dram_rank_size[1] +
-                    emi.emi_cfg.emi_v16.emi_cfg.m_dram_rank_size[2] +
-                    emi.emi_cfg.emi_v16.emi_cfg.m_dram_rank_size[3]);
-        }
-        else if(emi_ver == 0x11)
-        {
-            memcpy(&emi.emi_cfg.emi_v17, BldrInfo.mid(idx).data(), sizeof(emi.emi_cfg.emi_v17.emi_cfg));
-            idx += sizeof(emi.emi_cfg.emi_v17.emi_len);
-            if (!emi.emi_cfg.emi_v17.emi_cfg.m_type)
-                continue;
-
-            emi.m_emi_info = (qbyte((char*)&emi.emi_cfg.emi_v17.emi_cfg, sizeof(emi.emi_cfg.emi_v17.emi_cfg))); //fixed_len
-
-            qbyte dev_id = qbyte((char*)&emi.emi_cfg.emi_v17.emi_cfg.m_emmc_id, sizeof(emi.emi_cfg.emi_v17.emi_cfg.m_emmc_id));
-            dev_id.resize(emi.emi_cfg.emi_v17.emi_cfg.m_id_length);
-
-            mmcCARD::CIDInfo m_cid = {};
-            PraseCID(dev_id, m_cid);
-
-            emi.index = get_hex(i);
-            emi.flash_id = dev_id.toHex().data();
-            emi.manufacturer_id = m_cid.ManufacturerId;
-            emi.manufacturer = m_cid.Manufacturer;
-            emi.ProductName = m_cid.ProductName;
-            emi.OEMApplicationId = m_cid.OEMApplicationId;
-            emi.CardBGA = m_cid.CardBGA;
-            emi.dram_type = get_dram_type(emi.emi_cfg.emi_v17.emi_cfg.m_type);
-            emi.dram_size = get_unit(emi.emi_cfg.emi_v17.emi_cfg.m_dram_rank_size[0] +
-                    emi.emi_cfg.emi_v17.emi_cfg.m_dram_rank_size[1] +
-                    emi.emi_cfg.emi_v17.emi_cfg.m_dram_rank_size[2] +
-                    emi.emi_cfg.emi_v17.emi_cfg.m_dram_rank_size[3]);
-        }
-        else if(emi_ver == 0x12)
-        {
-            memcpy(&emi.emi_cfg.emi_v18, BldrInfo.mid(idx).data(), sizeof(emi.emi_cfg.emi_v18.emi_cfg));
-            idx += sizeof(emi.emi_cfg.emi_v18.emi_len);
-            if (!emi.emi_cfg.emi_v18.emi_cfg.m_type)
-                continue;
-
-            emi.m_emi_info = (qbyte((char*)&emi.emi_cfg.emi_v18.emi_cfg, sizeof(emi.emi_cfg.emi_v18.emi_cfg))); //fixed_len
-
-            qbyte dev_id = qbyte((char*)&emi.emi_cfg.emi_v18.emi_cfg.m_emmc_id, sizeof(emi.emi_cfg.emi_v18.emi_cfg.m_emmc_id));
-            dev_id.resize(emi.emi_cfg.emi_v18.emi_cfg.m_id_length);
-
-            mmcCARD::CIDInfo m_cid = {};
-            PraseCID(dev_id, m_cid);
-
-            emi.index = get_hex(i);
-            emi.flash_id = dev_id.toHex().data();
-            emi.manufacturer_id = m_cid.ManufacturerId;
-            emi.manufacturer = m_cid.Manufacturer;
-            emi.ProductName = m_cid.ProductName;
-            emi.OEMApplicationId = m_cid.OEMApplicationId;
-            emi.CardBGA = m_cid.CardBGA;
-            emi.dram_type = get_dram_type(emi.emi_cfg.emi_v18.emi_cfg.m_type);
-            emi.dram_size = get_unit(emi.emi_cfg.emi_v18.emi_cfg.m_dram_rank_size[0] +
-                    emi.emi_cfg.emi_v18.emi_cfg.m_dram_rank_size[1] +
-                    emi.emi_cfg.emi_v18.emi_cfg.m_dram_rank_size[2] +
-                    emi.emi_cfg.emi_v18.emi_cfg.m_dram_rank_size[3]);
-        }
-        else if(emi_ver == 0x13)
-        {
-            memcpy(&emi.emi_cfg.emi_v19, BldrInfo.mid(idx).data(), sizeof(emi.emi_cfg.emi_v19.emi_cfg));
-            idx += sizeof(emi.emi_cfg.emi_v19.emi_len);
-            if (!emi.emi_cfg.emi_v19.emi_cfg.m_type)
-                continue;
-
-            emi.m_emi_info = (qbyte((char*)&emi.emi_cfg.emi_v19.emi_cfg, sizeof(emi.emi_cfg.emi_v19.emi_cfg))); //fixed_len
-
-            qbyte dev_id = qbyte((char*)&emi.emi_cfg.emi_v19.emi_cfg.m_emmc_id, sizeof(emi.emi_cfg.emi_v19.emi_cfg.m_emmc_id));
-            dev_id.resize(emi.emi_cfg.emi_v19.emi_cfg.m_id_length);
-
-            mmcCARD::CIDInfo m_cid = {};
-            PraseCID(dev_id, m_cid);
-
-            emi.index = get_hex(i);
-            emi.flash_id = dev_id.toHex().data();
-            emi.manufacturer_id = m_cid.ManufacturerId;
-            emi.manufacturer = m_cid.Manufacturer;
-            emi.ProductName = m_cid.ProductName;
-            emi.OEMApplicationId = m_cid.OEMApplicationId;
-            emi.CardBGA = m_cid.CardBGA;
-            emi.dram_type = get_dram_type(emi.emi_cfg.emi_v19.emi_cfg.m_type);
-            emi.dram_size = get_unit(emi.emi_cfg.emi_v19.emi_cfg.m_dram_rank_size[0] +
-                    emi.emi_cfg.emi_v19.emi_cfg.m_dram_rank_size[1] +
-                    emi.emi_cfg.emi_v19.emi_cfg.m_dram_rank_size[2] +
-                    emi.emi_cfg.emi_v19.emi_cfg.m_dram_rank_size[3]);
-        }
-        else if(emi_ver == 0x14)
-        {
-            memcpy(&emi.emi_cfg.emi_v20, BldrInfo.mid(idx).data(), sizeof(emi.emi_cfg.emi_v20.emi_cfg));
-            idx += sizeof(emi.emi_cfg.emi_v20.emi_len);
-            if (!emi.emi_cfg.emi_v20.emi_cfg.m_type)
-                continue;
-
-            emi.m_emi_info = (qbyte((char*)&emi.emi_cfg.emi_v20.emi_cfg, sizeof(emi.emi_cfg.emi_v20.emi_cfg))); //fixed_len
-
-            qbyte dev_id = qbyte((char*)&emi.emi_cfg.emi_v20.emi_cfg.m_emmc_id, sizeof(emi.emi_cfg.emi_v20.emi_cfg.m_emmc_id));
-            dev_id.resize(emi.emi_cfg.emi_v20.emi_cfg.m_id_length);
-
-            mmcCARD::CIDInfo m_cid = {};
-            PraseCID(dev_id, m_cid);
-
-            emi.index = get_hex(i);
-            emi.flash_id = dev_id.toHex().data();
-            emi.manufacturer_id = m_cid.ManufacturerId;
-            emi.manufacturer = m_cid.Manufacturer;
-            emi.ProductName = m_cid.ProductName;
-            emi.OEMApplicationId = m_cid.OEMApplicationId;
-            emi.CardBGA = m_cid.CardBGA;
-            emi.dram_type = get_dram_type(emi.emi_cfg.emi_v20.emi_cfg.m_type);
-            emi.dram_size = get_unit(emi.emi_cfg.emi_v20.emi_cfg.m_dram_rank_size[0] +
-                    emi.emi_cfg.emi_v20.emi_cfg.m_dram_rank_size[1] +
-                    emi.emi_cfg.emi_v20.emi_cfg.m_dram_rank_size[2] +
-                    emi.emi_cfg.emi_v20.emi_cfg.m_dram_rank_size[3]);
-        }
-        else if(emi_ver == 0x15)
-        {
-            memcpy(&emi.emi_cfg.emi_v21, BldrInfo.mid(idx).data(), sizeof(emi.emi_cfg.emi_v21.emi_cfg));
-            idx += sizeof(emi.emi_cfg.emi_v21.emi_len);
-            if (!emi.emi_cfg.emi_v21.emi_cfg.m_type)
-                continue;
-
-            emi.m_emi_info = (qbyte((char*)&emi.emi_cfg.emi_v21.emi_cfg, sizeof(emi.emi_cfg.emi_v21.emi_cfg))); //fixed_len
-
-            qbyte dev_id = qbyte((char*)&emi.emi_cfg.emi_v21.emi_cfg.m_emmc_id, sizeof(emi.emi_cfg.emi_v21.emi_cfg.m_emmc_id));
-            dev_id.resize(emi.emi_cfg.emi_v21.emi_cfg.m_id_length);
-
-            mmcCARD::CIDInfo m_cid = {};
-            PraseCID(dev_id, m_cid);
-
-            emi.index = get_hex(i);
-            emi.flash_id = dev_id.toHex().data();
-            emi.manufacturer_id = m_cid.ManufacturerId;
-            emi.manufacturer = m_cid.Manufacturer;
-            emi.ProductName = m_cid.ProductName;
-            emi.OEMApplicationId = m_cid.OEMApplicationId;
-            emi.CardBGA = m_cid.CardBGA;
-            emi.dram_type = get_dram_type(emi.emi_cfg.emi_v21.emi_cfg.m_type);
-            emi.dram_size = get_unit(emi.emi_cfg.emi_v21.emi_cfg.m_dram_rank_size[0] +
-                    emi.emi_cfg.emi_v21.emi_cfg.m_dram_rank_size[1] +
-                    emi.emi_cfg.emi_v21.emi_cfg.m_dram_rank_size[2] +
-                    emi.emi_cfg.emi_v21.emi_cfg.m_dram_rank_size[3]);
-        }
-        else if(emi_ver == 0x16)
-        {
-            memcpy(&emi.emi_cfg.emi_v22, BldrInfo.mid(idx).data(), sizeof(emi.emi_cfg.emi_v22.emi_cfg));
-            idx += sizeof(emi.emi_cfg.emi_v22.emi_len);
-            if (!emi.emi_cfg.emi_v22.emi_cfg.m_type)
-                continue;
-
-            emi.m_emi_info = (qbyte((char*)&emi.emi_cfg.emi_v22.emi_cfg, sizeof(emi.emi_cfg.emi_v22.emi_cfg))); //fixed_len
-
-            qbyte dev_id = qbyte((char*)&emi.emi_cfg.emi_v22.emi_cfg.m_emmc_id, sizeof(emi.emi_cfg.emi_v22.emi_cfg.m_emmc_id));
-            dev_id.resize(emi.emi_cfg.emi_v22.emi_cfg.m_id_length);
-
-            mmcCARD::CIDInfo m_cid = {};
-            PraseCID(dev_id, m_cid);
-
-            emi.index = get_hex(i);
-            emi.flash_id = dev_id.toHex().data();
-            emi.manufacturer_id = m_cid.ManufacturerId;
-            emi.manufacturer = m_cid.Manufacturer;
-            emi.ProductName = m_cid.ProductName;
-            emi.OEMApplicationId = m_cid.OEMApplicationId;
-            emi.CardBGA = m_cid.CardBGA;
-            emi.dram_type = get_dram_type(emi.emi_cfg.emi_v22.emi_cfg.m_type);
-            emi.dram_size = get_unit(emi.emi_cfg.emi_v22.emi_cfg.m_dram_rank_size[0] +
-                    emi.emi_cfg.emi_v22.emi_cfg.m_dram_rank_size[1] +
-                    emi.emi_cfg.emi_v22.emi_cfg.m_dram_rank_size[2] +
-                    emi.emi_cfg.emi_v22.emi_cfg.m_dram_rank_size[3]);
-        }
-        else if(emi_ver == 0x17)
-        {
-            memcpy(&emi.emi_cfg.emi_v23, BldrInfo.mid(idx).data(), sizeof(emi.emi_cfg.emi_v23.emi_cfg));
-            idx += sizeof(emi.emi_cfg.emi_v23.emi_len);
-            if (!emi.emi_cfg.emi_v23.emi_cfg.m_type)
-                continue;
-
-            emi.m_emi_info = (qbyte((char*)&emi.emi_cfg.emi_v23.emi_cfg, sizeof(emi.emi_cfg.emi_v23.emi_cfg))); //fixed_len
-
-            qbyte dev_id = qbyte((char*)&emi.emi_cfg.emi_v23.emi_cfg.m_emmc_id, sizeof(emi.emi_cfg.emi_v23.emi_cfg.m_emmc_id));
-            dev_id.resize(emi.emi_cfg.emi_v23.emi_cfg.m_id_length);
-
-            mmcCARD::CIDInfo m_cid = {};
-            PraseCID(dev_id, m_cid);
-
-            emi.index = get_hex(i);
-            emi.flash_id = dev_id.toHex().data();
-            emi.manufacturer_id = m_cid.ManufacturerId;
-            emi.manufacturer = m_cid.Manufacturer;
-            emi.ProductName = m_cid.ProductName;
-            emi.OEMApplicationId = m_cid.OEMApplicationId;
-            emi.CardBGA = m_cid.CardBGA;
-            emi.dram_type = get_dram_type(emi.emi_cfg.emi_v23.emi_cfg.m_type);
-            emi.dram_size = get_unit(emi.emi_cfg.emi_v23.emi_cfg.m_dram_rank_size[0] +
-                    emi.emi_cfg.emi_v23.emi_cfg.m_dram_rank_size[1] +
-                    emi.emi_cfg.emi_v23.emi_cfg.m_dram_rank_size[2] +
-                    emi.emi_cfg.emi_v23.emi_cfg.m_dram_rank_size[3]);
-        }
-        else if(emi_ver == 0x18)
-        {
-            memcpy(&emi.emi_cfg.emi_v24, BldrInfo.mid(idx).data(), sizeof(emi.emi_cfg.emi_v24.emi_cfg));
-            idx += sizeof(emi.emi_cfg.emi_v24.emi_len);
-            if (!emi.emi_cfg.emi_v24.emi_cfg.m_type)
-                continue;
-
-            emi.m_emi_info = (qbyte((char*)&emi.emi_cfg.emi_v24.emi_cfg, sizeof(emi.emi_cfg.emi_v24.emi_cfg))); //fixed_len
-
-            qbyte dev_id = qbyte((char*)&emi.emi_cfg.emi_v24.emi_cfg.m_emmc_id, sizeof(emi.emi_cfg.emi_v24.emi_cfg.m_emmc_id));
-            dev_id.resize(emi.emi_cfg.emi_v24.emi_cfg.m_id_length);
-
-            mmcCARD::CIDInfo m_cid = {};
-            PraseCID(dev_id, m_cid);
-
-            emi.index = get_hex(i);
-            emi.flash_id = dev_id.toHex().data();
-            emi.manufacturer_id = m_cid.ManufacturerId;
-            emi.manufacturer = m_cid.Manufacturer;
-            emi.ProductName = m_cid.ProductName;
-            emi.OEMApplicationId = m_cid.OEMApplicationId;
-            emi.CardBGA = m_cid.CardBGA;
-            emi.dram_type = get_dram_type(emi.emi_cfg.emi_v24.emi_cfg.m_type);
-            emi.dram_size = get_unit(emi.emi_cfg.emi_v24.emi_cfg.m_dram_rank_size[0] +
-                    emi.emi_cfg.emi_v24.emi_cfg.m_dram_rank_size[1] +
-                    emi.emi_cfg.emi_v24.emi_cfg.m_dram_rank_size[2] +
-                    emi.emi_cfg.emi_v24.emi_cfg.m_dram_rank_size[3]);
-        }
-        else if(emi_ver == 0x19)
-        {
-            memcpy(&emi.emi_cfg.emi_v25, BldrInfo.mid(idx).data(), sizeof(emi.emi_cfg.emi_v25.emi_cfg));
-            idx += sizeof(emi.emi_cfg.emi_v25.emi_len);
-            if (!emi.emi_cfg.emi_v25.emi_cfg.m_type)
-                continue;
-
-            emi.m_emi_info = (qbyte((char*)&emi.emi_cfg.emi_v25.emi_cfg, sizeof(emi.emi_cfg.emi_v25.emi_cfg))); //fixed_len
-
-            qbyte dev_id = qbyte((char*)&emi.emi_cfg.emi_v25.emi_cfg.m_emmc_id, sizeof(emi.emi_cfg.emi_v25.emi_cfg.m_emmc_id));
-            dev_id.resize(emi.emi_cfg.emi_v25.emi_cfg.m_id_length);
-
-            mmcCARD::CIDInfo m_cid = {};
-            PraseCID(dev_id, m_cid);
-
-            emi.index = get_hex(i);
-            emi.flash_id = dev_id.toHex().data();
-            emi.manufacturer_id = m_cid.ManufacturerId;
-            emi.manufacturer = m_cid.Manufacturer;
-            emi.ProductName = m_cid.ProductName;
-            emi.OEMApplicationId = m_cid.OEMApplicationId;
-            emi.CardBGA = m_cid.CardBGA;
-            emi.dram_type = get_dram_type(emi.emi_cfg.emi_v25.emi_cfg.m_type);
-            emi.dram_size = get_unit(emi.emi_cfg.emi_v25.emi_cfg.m_dram_rank_size[0] +
-                    emi.emi_cfg.emi_v25.emi_cfg.m_dram_rank_size[1] +
-                    emi.emi_cfg.emi_v25.emi_cfg.m_dram_rank_size[2] +
-                    emi.emi_cfg.emi_v25.emi_cfg.m_dram_rank_size[3]);
-        }
-        else if(emi_ver == 0x1b)
-        {
-            memcpy(&emi.emi_cfg.emi_v27, BldrInfo.mid(idx).data(), sizeof(emi.emi_cfg.emi_v27.emi_cfg));
-            idx += sizeof(emi.emi_cfg.emi_v27.emi_len);
-            if (!emi.emi_cfg.emi_v27.emi_cfg.m_type)
-                continue;
-
-            emi.m_emi_info = (qbyte((char*)&emi.emi_cfg.emi_v27.emi_cfg, sizeof(emi.emi_cfg.emi_v27.emi_cfg))); //fixed_len
-
-            qbyte dev_id = qbyte((char*)&emi.emi_cfg.emi_v27.emi_cfg.m_emmc_id, sizeof(emi.emi_cfg.emi_v27.emi_cfg.m_emmc_id));
-            dev_id.resize(emi.emi_cfg.emi_v27.emi_cfg.m_id_length);
-
-            mmcCARD::CIDInfo m_cid = {};
-            PraseCID(dev_id, m_cid);
-
-            emi.index = get_hex(i);
-            emi.flash_id = dev_id.toHex().data();
-            emi.manufacturer_id = m_cid.ManufacturerId;
-            emi.manufacturer = m_cid.Manufacturer;
-            emi.ProductName = m_cid.ProductName;
-            emi.OEMApplicationId = m_cid.OEMApplicationId;
-            emi.CardBGA = m_cid.CardBGA;
-            emi.dram_type = get_dram_type(emi.emi_cfg.emi_v27.emi_cfg.m_type);
-            emi.dram_size = get_unit(emi.emi_cfg.emi_v27.emi_cfg.m_dram_rank_size[0] +
-                    emi.emi_cfg.emi_v27.emi_cfg.m_dram_rank_size[1] +
-                    emi.emi_cfg.emi_v27.emi_cfg.m_dram_rank_size[2] +
-                    emi.emi_cfg.emi_v27.emi_cfg.m_dram_rank_size[3]);
-        }
-        else if(emi_ver == 0x1c)
-        {
-            memcpy(&emi.emi_cfg.emi_v28, BldrInfo.mid(idx).data(), sizeof(emi.emi_cfg.emi_v28.emi_cfg));
-            idx += sizeof(emi.emi_cfg.emi_v28.emi_len);
-            if (!emi.emi_cfg.emi_v28.emi_cfg.m_type)
-                continue;
-
-            emi.m_emi_info = (qbyte((char*)&emi.emi_cfg.emi_v28.emi_cfg, sizeof(emi.emi_cfg.emi_v28.emi_cfg))); //fixed_len
-
-            qbyte dev_id = qbyte((char*)&emi.emi_cfg.emi_v28.emi_cfg.m_emmc_id, sizeof(emi.emi_cfg.emi_v28.emi_cfg.m_emmc_id));
-            //dev_id.resize(emi.emi_cfg.emi_v28.emi_cfg.m_id_length);
-
-            mmcCARD::CIDInfo m_cid = {};
-            PraseCID(dev_id, m_cid);
-
-            emi.index = get_hex(i);
-            emi.flash_id = dev_id.toHex().data();
-            emi.manufacturer_id = m_cid.ManufacturerId;
-            emi.manufacturer = m_cid.Manufacturer;
-            emi.ProductName = m_cid.ProductName;
-            emi.OEMApplicationId = m_cid.OEMApplicationId;
-            emi.CardBGA = m_cid.CardBGA;
-            emi.dram_type = get_dram_type(emi.emi_cfg.emi_v28.emi_cfg.m_type);
-            emi.dram_size = get_unit(emi.emi_cfg.emi_v28.emi_cfg.m_dram_rank_size[0] +
-                    emi.emi_cfg.emi_v28.emi_cfg.m_dram_rank_size[1] +
-                    emi.emi_cfg.emi_v28.emi_cfg.m_dram_rank_size[2] +
-                    emi.emi_cfg.emi_v28.emi_cfg.m_dram_rank_size[3]);
-        }
-        else if(emi_ver == 0x1e)
-        {
-            memcpy(&emi.emi_cfg.emi_v30, BldrInfo.mid(idx).data(), sizeof(emi.emi_cfg.emi_v30.emi_cfg));
-            idx += sizeof(emi.emi_cfg.emi_v30.emi_len);
-            if (!emi.emi_cfg.emi_v30.emi_cfg.m_type)
-                continue;
-
-            emi.m_emi_info = (qbyte((char*)&emi.emi_cfg.emi_v30.emi_cfg, sizeof(emi.emi_cfg.emi_v30.emi_cfg))); //fixed_len
-
-            qbyte dev_id = qbyte((char*)&emi.emi_cfg.emi_v30.emi_cfg.m_emmc_id, sizeof(emi.emi_cfg.emi_v30.emi_cfg.m_emmc_id));
-            dev_id.resize(emi.emi_cfg.emi_v30.emi_cfg.m_id_length);
-
-            mmcCARD::CIDInfo m_cid = {};
-            PraseCID(dev_id, m_cid);
-
-            emi.index = get_hex(i);
-            emi.flash_id = dev_id.toHex().data();
-            emi.manufacturer_id = m_cid.ManufacturerId;
-            emi.manufacturer = m_cid.Manufacturer;
-            emi.ProductName = m_cid.ProductName;
-            emi.OEMApplicationId = m_cid.OEMApplicationId;
-            emi.CardBGA = m_cid.CardBGA;
-            emi.dram_type = get_dram_type(emi.emi_cfg.emi_v30.emi_cfg.m_type);
-            emi.dram_size = get_unit(emi.emi_cfg.emi_v30.emi_cfg.m_dram_rank_size[0] +
-                    emi.emi_cfg.emi_v30.emi_cfg.m_dram_rank_size[1] +
-                    emi.emi_cfg.emi_v30.emi_cfg.m_dram_rank_size[2] +
-                    emi.emi_cfg.emi_v30.emi_cfg.m_dram_rank_size[3]);
-        }
-        else if(emi_ver == 0x1f)
-        {
-            memcpy(&emi.emi_cfg.emi_v31, BldrInfo.mid(idx).data(), sizeof(emi.emi_cfg.emi_v31.emi_cfg));
-            idx += sizeof(emi.emi_cfg.emi_v31.emi_len);
-            if (!emi.emi_cfg.emi_v31.emi_cfg.m_type)
-                continue;
-
-            emi.m_emi_info = (qbyte((char*)&emi.emi_cfg.emi_v31.emi_cfg, sizeof(emi.emi_cfg.emi_v31.emi_cfg))); //fixed_len
-
-            qbyte dev_id = qbyte((char*)&emi.emi_cfg.emi_v31.emi_cfg.m_emmc_id, sizeof(emi.emi_cfg.emi_v31.emi_cfg.m_emmc_id));
-            dev_id.resize(emi.emi_cfg.emi_v31.emi_cfg.m_id_length);
-
-            mmcCARD::CIDInfo m_cid = {};
-            PraseCID(dev_id, m_cid);
-
-            emi.index = get_hex(i);
-            emi.flash_id = dev_id.toHex().data();
-            emi.manufacturer_id = m_cid.ManufacturerId;
-            emi.manufacturer = m_cid.Manufacturer;
-            emi.ProductName = m_cid.ProductName;
-            emi.OEMApplicationId = m_cid.OEMApplicationId;
-            emi.CardBGA = m_cid.CardBGA;
-            emi.dram_type = get_dram_type(emi.emi_cfg.emi_v31.emi_cfg.m_type);
-            emi.dram_size = get_unit(emi.emi_cfg.emi_v31.emi_cfg.m_dram_rank_size[0] +
-                    emi.emi_cfg.emi_v31.emi_cfg.m_dram_rank_size[1] +
-                    emi.emi_cfg.emi_v31.emi_cfg.m_dram_rank_size[2] +
-                    emi.emi_cfg.emi_v31.emi_cfg.m_dram_rank_size[3]);
-        }
-        else if(emi_ver == 0x20)
-        {
-            memcpy(&emi.emi_cfg.emi_v32, BldrInfo.mid(idx).data(), sizeof(emi.emi_cfg.emi_v32.emi_cfg));
-            idx += sizeof(emi.emi_cfg.emi_v32.emi_len);
-            if (!emi.emi_cfg.emi_v32.emi_cfg.m_type)
-                continue;
-
-            emi.m_emi_info = (qbyte((char*)&emi.emi_cfg.emi_v32.emi_cfg, sizeof(emi.emi_cfg.emi_v32.emi_cfg))); //fixed_len
-
-            qbyte dev_id = qbyte((char*)&emi.emi_cfg.emi_v32.emi_cfg.m_emmc_id, sizeof(emi.emi_cfg.emi_v32.emi_cfg.m_emmc_id));
-            dev_id.resize(emi.emi_cfg.emi_v32.emi_cfg.m_id_length);
-
-            mmcCARD::CIDInfo m_cid = {};
-            PraseCID(dev_id, m_cid);
-
-            emi.index = get_hex(i);
-            emi.flash_id = dev_id.toHex().data();
-            emi.manufacturer_id = m_cid.ManufacturerId;
-            emi.manufacturer = m_cid.Manufacturer;
-            emi.ProductName = m_cid.ProductName;
-            emi.OEMApplicationId = m_cid.OEMApplicationId;
-            emi.CardBGA = m_cid.CardBGA;
-            emi.dram_type = get_dram_type(emi.emi_cfg.emi_v32.emi_cfg.m_type);
-            emi.dram_size = get_unit(emi.emi_cfg.emi_v32.emi_cfg.m_dram_rank_size[0] +
-                    emi.emi_cfg.emi_v32.emi_cfg.m_dram_rank_size[1] +
-                    emi.emi_cfg.emi_v32.emi_cfg.m_dram_rank_size[2] +
-                    emi.emi_cfg.emi_v32.emi_cfg.m_dram_rank_size[3]);
-        }
-        else if(emi_ver == 0x23)
-        {
-            memcpy(&emi.emi_cfg.emi_v35, BldrInfo.mid(idx).data(), sizeof(emi.emi_cfg.emi_v35.emi_cfg));
-            idx += sizeof(emi.emi_cfg.emi_v35.emi_len);
-            if (!emi.emi_cfg.emi_v35.emi_cfg.m_type)
-                continue;
-
-            emi.m_emi_info = (qbyte((char*)&emi.emi_cfg.emi_v35.emi_cfg, sizeof(emi.emi_cfg.emi_v35.emi_cfg))); //fixed_len
-
-            qbyte dev_id = qbyte((char*)&emi.emi_cfg.emi_v35.emi_cfg.m_emmc_id, sizeof(emi.emi_cfg.emi_v35.emi_cfg.m_emmc_id));
-            dev_id.resize(emi.emi_cfg.emi_v35.emi_cfg.m_id_length);
-
-            mmcCARD::CIDInfo m_cid = {};
-            PraseCID(dev_id, m_cid);
-
-            emi.index = get_hex(i);
-            emi.flash_id = dev_id.toHex().data();
-            emi.manufacturer_id = m_cid.ManufacturerId;
-            emi.manufacturer = m_cid.Manufacturer;
-            emi.ProductName = m_cid.ProductName;
-            emi.OEMApplicationId = m_cid.OEMApplicationId;
-            emi.CardBGA = m_cid.CardBGA;
-            emi.dram_type = get_dram_type(emi.emi_cfg.emi_v35.emi_cfg.m_type);
-            emi.dram_size = get_unit(emi.emi_cfg.emi_v35.emi_cfg.m_dram_rank_size[0] +
-                    emi.emi_cfg.emi_v35.emi_cfg.m_dram_rank_size[1] +
-                    emi.emi_cfg.emi_v35.emi_cfg.m_dram_rank_size[2] +
-                    emi.emi_cfg.emi_v35.emi_cfg.m_dram_rank_size[3]);
-        }
-        else if(emi_ver == 0x24)
-        {
-            memcpy(&emi.emi_cfg.emi_v36, BldrInfo.mid(idx).data(), sizeof(emi.emi_cfg.emi_v36.emi_cfg));
-            idx += sizeof(emi.emi_cfg.emi_v36.emi_len);
-            if (!emi.emi_cfg.emi_v36.emi_cfg.m_type)
-                continue;
-
-            emi.m_emi_info = (qbyte((char*)&emi.emi_cfg.emi_v36.emi_cfg, sizeof(emi.emi_cfg.emi_v36.emi_cfg))); //fixed_len
-
-            qbyte dev_id = qbyte((char*)&emi.emi_cfg.emi_v36.emi_cfg.m_emmc_id, sizeof(emi.emi_cfg.emi_v36.emi_cfg.m_emmc_id));
-            dev_id.resize(emi.emi_cfg.emi_v36.emi_cfg.m_id_length);
-
-            mmcCARD::CIDInfo m_cid = {};
-            PraseCID(dev_id, m_cid);
-
-            emi.index = get_hex(i);
-            emi.flash_id = dev_id.toHex().data();
-            emi.manufacturer_id = m_cid.ManufacturerId;
-            emi.manufacturer = m_cid.Manufacturer;
-            emi.ProductName = m_cid.ProductName;
-            emi.OEMApplicationId = m_cid.OEMApplicationId;
-            emi.CardBGA = m_cid.CardBGA;
-            emi.dram_type = get_dram_type(emi.emi_cfg.emi_v36.emi_cfg.m_type);
-            emi.dram_size = get_unit(emi.emi_cfg.emi_v36.emi_cfg.m_dram_rank_size[0] +
-                    emi.emi_cfg.emi_v36.emi_cfg.m_dram_rank_size[1] +
-                    emi.emi_cfg.emi_v36.emi_cfg.m_dram_rank_size[2] +
-                    emi.emi_cfg.emi_v36.emi_cfg.m_dram_rank_size[3]);
-        }
-        else if(emi_ver == 0x26)
-        {
-            memcpy(&emi.emi_cfg.emi_v38, BldrInfo.mid(idx).data(), sizeof(emi.emi_cfg.emi_v38.emi_cfg));
-            idx += sizeof(emi.emi_cfg.emi_v38.emi_len);
-            if (!emi.emi_cfg.emi_v38.emi_cfg.m_type)
-                continue;
-
-            emi.m_emi_info = (qbyte((char*)&emi.emi_cfg.emi_v38.emi_cfg, sizeof(emi.emi_cfg.emi_v38.emi_cfg))); //fixed_len
-
-            qbyte dev_id = qbyte((char*)&emi.emi_cfg.emi_v38.emi_cfg.m_emmc_id, sizeof(emi.emi_cfg.emi_v38.emi_cfg.m_emmc_id));
-            dev_id.resize(emi.emi_cfg.emi_v38.emi_cfg.m_id_length);
-
-            mmcCARD::CIDInfo m_cid = {};
-            PraseCID(dev_id, m_cid);
-
-            emi.index = get_hex(i);
-            emi.flash_id = dev_id.toHex().data();
-            emi.manufacturer_id = m_cid.ManufacturerId;
-            emi.manufacturer = m_cid.Manufacturer;
-            emi.ProductName = m_cid.ProductName;
-            emi.OEMApplicationId = m_cid.OEMApplicationId;
-            emi.CardBGA = m_cid.CardBGA;
-            emi.dram_type = get_dram_type(emi.emi_cfg.emi_v38.emi_cfg.m_type);
-            emi.dram_size = get_unit(emi.emi_cfg.emi_v38.emi_cfg.m_dram_rank_size[0] +
-                    emi.emi_cfg.emi_v38.emi_cfg.m_dram_rank_size[1] +
-                    emi.emi_cfg.emi_v38.emi_cfg.m_dram_rank_size[2] +
-                    emi.emi_cfg.emi_v38.emi_cfg.m_dram_rank_size[3]);
-        }
-        else if(emi_ver == 0x27
-                || emi_ver == 0x28
-                || emi_ver == 0x2d
-                || emi_ver == 0x2f) //MTK_BLOADER_INFO_v39 => MTK EMI V2 combo mode. !common.
-        {
-            memcpy(&emi.emi_cfg.emi_v39, BldrInfo.mid(idx).data(), sizeof(emi.emi_cfg.emi_v39.emi_cfg));
-            idx += sizeof(emi.emi_cfg.emi_v39.emi_len);
-            if (!emi.emi_cfg.emi_v39.emi_cfg.m_type)
-                continue;
+        log(qstr("EMI version not supported{%0}").arg(get_hex(emi_ver)));
+        return 0;
+    }
 
-            emi.m_emi_info = (qbyte((char*)&emi.emi_cfg.emi_v39.emi_cfg, sizeof(emi.emi_cfg.emi_v39.emi_cfg))); //fixed_len
+    //!records point into this copy, the view dies with the image.
+    m_blob = qbyte(BldrInfo.constData(), BldrInfo.size());
 
-            bool is_ufs(emi.emi_cfg.emi_v39.emi_cfg.m_id_length != 0x9);//len = 0x9 = eMMC & 0xe, 0xf = eUFS
+    //!everything the record loop relies on is checked here, once.
+    return validate_blob(emi_layout);
+}
 
-            qbyte dev_id = qbyte((char*)&emi.emi_cfg.emi_v39.emi_cfg.m_emmc_id, sizeof(emi.emi_cfg.emi_v39.emi_cfg.m_emmc_id));
-            dev_id.resize(emi.emi_cfg.emi_v39.emi_cfg.m_id_length);
+void EMIParser::Decode(QVector<mtkPreloader::MTKEMIInfo> &emis)
+{
+    if (!m_layout) //!nothing located or the blob didn't validate.
+        return;
+
+    //!same blob => same records, no need to decode them again.
+    qlong blob_key = m_cache? emi_xxh64(m_blob): 0;
+    if (m_cache && m_cache->Lookup(blob_key, m_blob.size(), emis))
+        return;
+
+    qsizetype first_emi = emis.size();
+    emis.reserve(first_emi + m_records);
+
+    //!validate_blob() put all of these inside the blob, no checks per record.
+    quint i = 0;
+    qsizetype idx = sizeof(MTKBLOADERINFO);
+    for (; i < m_full_records; i++, idx += m_layout->rec_len)
+        decode_record(m_blob.constData() + idx, i, idx, emis);
+
+    //!the records the blob end cuts short read as zero padded.
+    char emi_cfg[sizeof(mtkPreloader::MTKEMIRecord)];
+    for (; i < m_records; i++, idx += m_layout->rec_len)
+    {
+        memset(emi_cfg, 0x00, m_layout->cfg_len);
+        memcpy(emi_cfg, m_blob.constData() + idx, qMin<qsizetype>(m_layout->cfg_len, m_blob.size() - idx));
+        decode_record(emi_cfg, i, idx, emis);
+    }
 
-            mmcCARD::CIDInfo m_cid = {};
-            PraseCID(dev_id, m_cid, is_ufs);
+    if (m_cache)
+        m_cache->Insert(blob_key, m_blob.size(), emis.constData() + first_emi, emis.size() - first_emi);
+}
 
-            emi.index = get_hex(i);
-            emi.flash_id = dev_id.toHex().data();
-            emi.manufacturer_id = m_cid.ManufacturerId;
-            emi.manufacturer = m_cid.Manufacturer;
-            emi.ProductName = m_cid.ProductName;
-            emi.OEMApplicationId = m_cid.OEMApplicationId;
-            emi.CardBGA = m_cid.CardBGA;
-            emi.dram_type = get_dram_type(emi.emi_cfg.emi_v39.emi_cfg.m_type);
-            emi.dram_size = get_unit(emi.emi_cfg.emi_v39.emi_cfg.m_dram_rank_size[0] +
-                    emi.emi_cfg.emi_v39.emi_cfg.m_dram_rank_size[1] +
-                    emi.emi_cfg.emi_v39.emi_cfg.m_dram_rank_size[2] +
-                    emi.emi_cfg.emi_v39.emi_cfg.m_dram_rank_size[3]);
-        }
-        else if(emi_ver == 0x2e) //MTK_BLOADER_INFO_v46
-        {
-            memcpy(&emi.emi_cfg.emi_v46, BldrInfo.mid(idx).data(), sizeof(emi.emi_cfg.emi_v46.emi_cfg));
-            idx += sizeof(emi.emi_cfg.emi_v46.emi_len);
-            if (!emi.emi_cfg.emi_v46.emi_cfg.m_type)
-                continue;
+bool EMIParser::validate_blob(const mtkPreloader::EMILayout *emi_layout)
+{
+    if (m_blob.size() < (qsizetype)sizeof(MTKBLOADERINFO))
+    {
+        log(qstr("truncated mtk_bloader_info header{%0}").arg(get_hex(m_blob.size())));
+        return 0;
+    }
 
-            emi.m_emi_info = (qbyte((char*)&emi.emi_cfg.emi_v46.emi_cfg, sizeof(emi.emi_cfg.emi_v46.emi_cfg))); //fixed_len
+    const char *bin_id = m_blob.constData() + offsetof(MTKBLOADERINFO, m_bin_identifier);
+    if (memcmp(bin_id, MTK_BIN_IDENTIFIER, strlen(MTK_BIN_IDENTIFIER)))
+    {
+        log(qstr("invalid mtk_bloader_info bin identifier{%0}").arg(qbyte(bin_id, sizeof(MTKBLOADERINFO::m_bin_identifier)).toHex().data()));
+        return 0;
+    }
 
-            bool is_ufs(emi.emi_cfg.emi_v46.emi_cfg.m_id_length != 0x9);//len = 0x9 = eMMC & 0xe, 0xf = eUFS
+    //!records run up to the blob end at most, a count past it (truncated blob or garbage) is clamped.
+    //!full records hold the whole emi_cfg, the ones after them are cut short by the blob end.
+    qint64 body = m_blob.size() - sizeof(MTKBLOADERINFO);
+    qint64 records = (body + emi_layout->rec_len - 1) / emi_layout->rec_len;
+    qint64 full_records = (body >= emi_layout->cfg_len)? (body - emi_layout->cfg_len) / emi_layout->rec_len + 1: 0;
 
-            qbyte dev_id = qbyte((char*)&emi.emi_cfg.emi_v46.emi_cfg.m_ufs_id, sizeof(emi.emi_cfg.emi_v46.emi_cfg.m_ufs_id));
-            dev_id.resize(emi.emi_cfg.emi_v46.emi_cfg.m_id_length);
+    m_records = qMin<qint64>(m_header.num_records, records);
+    m_full_records = qMin<qint64>(m_records, full_records);
+    m_layout = emi_layout;
+    return 1;
+}
 
-            mmcCARD::CIDInfo m_cid = {};
-            PraseCID(dev_id, m_cid, is_ufs);
+void EMIParser::decode_record(const char *emi_cfg, quint index, qsizetype blob_off, QVector<mtkPreloader::MTKEMIInfo> &emis) const
+{
+    quint emi_type = get_field<quint>(emi_cfg, m_layout->type_off);
+    if (!emi_type)
+        return;
+
+    mtkPreloader::MTKEMIInfo emi = {};
+    emi.index = index;
+    emi.emi_ver = m_header.emi_ver;
+    emi.dram_type = (mtkPreloader::EMIDramType)emi_type;
+    emi.blob_off = blob_off;
+    emi.cfg_len = m_layout->cfg_len; //fixed_len
+
+    emi.id_len = m_layout->id_size;
+    if (m_layout->id_len_off != EMI_NO_ID_LEN)
+    {
+        quint id_length = get_field<quint>(emi_cfg, m_layout->id_len_off);
+        emi.is_ufs = m_layout->combo && id_length != 0x9; //len = 0x9 = eMMC & 0xe, 0xf = eUFS
+        emi.id_len = qMin<quint>(id_length, m_layout->id_size);
+    }
 
-            emi.index = get_hex(i);
-            emi.flash_id = dev_id.toHex().data();
-            emi.manufacturer_id = m_cid.ManufacturerId;
-            emi.manufacturer = m_cid.Manufacturer;
-            emi.ProductName = m_cid.ProductName;
-            emi.OEMApplicationId = m_cid.OEMApplicationId;
-            emi.CardBGA = m_cid.CardBGA;
-            emi.dram_type = get_dram_type(emi.emi_cfg.emi_v46.emi_cfg.m_type);
-            emi.dram_size = get_unit(emi.emi_cfg.emi_v46.emi_cfg.m_dram_rank_size[0] +
-                    emi.emi_cfg.emi_v46.emi_cfg.m_dram_rank_size[1] +
-                    emi.emi_cfg.emi_v46.emi_cfg.m_dram_rank_size[2] +
-                    emi.emi_cfg.emi_v46.emi_cfg.m_dram_rank_size[3]);
-        }
-        else if(emi_ver == 0x31 || emi_ver == 0x34 || emi_ver == 0x36) //MTK_BLOADER_INFO_v49 - MTK_BLOADER_INFO_v52 - MTK_BLOADER_INFO_v54
-        {
-            memcpy(&emi.emi_cfg.emi_v49, BldrInfo.mid(idx).data(), sizeof(emi.emi_cfg.emi_v49.emi_cfg));
-            idx += sizeof(emi.emi_cfg.emi_v49.emi_len);
-            if (!emi.emi_cfg.emi_v49.emi_cfg.m_type)
-                continue;
+    if (m_layout->fw_len_off != EMI_NO_FW_LEN)
+    {
+        emi.fw_id_len = qMin<quint>(get_field<quint>(emi_cfg, m_layout->fw_len_off), sizeof(emi.fw_id));
+        memcpy(emi.fw_id, emi_cfg + m_layout->fw_id_off, emi.fw_id_len);
+    }
 
-            emi.m_emi_info = (qbyte((char*)&emi.emi_cfg.emi_v49.emi_cfg, sizeof(emi.emi_cfg.emi_v49.emi_cfg))); //fixed_len
-
-            bool is_ufs(emi.emi_cfg.emi_v49.emi_cfg.m_id_length != 0x9);//len = 0x9 = eMMC & 0xe, 0xf = eUFS
-            qbyte dev_id = qbyte((char*)&emi.emi_cfg.emi_v49.emi_cfg.m_ufs_id, sizeof(emi.emi_cfg.emi_v49.emi_cfg.m_ufs_id));
-            dev_id.resize(emi.emi_cfg.emi_v49.emi_cfg.m_id_length);
-
-            mmcCARD::CIDInfo m_cid = {};
-            PraseCID(dev_id, m_cid, is_ufs);
-
-            emi.index = get_hex(i);
-            emi.flash_id = dev_id.toHex().data();
-            emi.manufacturer_id = m_cid.ManufacturerId;
-            emi.manufacturer = m_cid.Manufacturer;
-            emi.ProductName = m_cid.ProductName;
-            emi.OEMApplicationId = m_cid.OEMApplicationId;
-            emi.CardBGA = m_cid.CardBGA;
-            emi.dram_type = get_dram_type(emi.emi_cfg.emi_v49.emi_cfg.m_type);
-            emi.dram_size = get_unit(emi.emi_cfg.emi_v49.emi_cfg.m_dram_rank_size[0] +
-                    emi.emi_cfg.emi_v49.emi_cfg.m_dram_rank_size[1] +
-                    emi.emi_cfg.emi_v49.emi_cfg.m_dram_rank_size[2] +
-                    emi.emi_cfg.emi_v49.emi_cfg.m_dram_rank_size[3]);
-        }
-        else if(emi_ver == 0x33) //MTK_BLOADER_INFO_v51
-        {
-            memcpy(&emi.emi_cfg.emi_v51, BldrInfo.mid(idx).data(), sizeof(emi.emi_cfg.emi_v51.emi_cfg));
-            idx += sizeof(emi.emi_cfg.emi_v51.emi_len);
-            if (!emi.emi_cfg.emi_v51.emi_cfg.m_type)
-                continue;
+    if (!emi.id_len)
+        return;
+    memcpy(emi.flash_id, emi_cfg + m_layout->id_off, emi.id_len);
 
-            emi.m_emi_info = (qbyte((char*)&emi.emi_cfg.emi_v51.emi_cfg, sizeof(emi.emi_cfg.emi_v51.emi_cfg))); //fixed_len
-
-            bool is_ufs(emi.emi_cfg.emi_v51.emi_cfg.m_id_length != 0x9);//len = 0x9 = eMMC & 0xe, 0xf = eUFS
-            qbyte dev_id = qbyte((char*)&emi.emi_cfg.emi_v51.emi_cfg.m_ufs_id, sizeof(emi.emi_cfg.emi_v51.emi_cfg.m_ufs_id));
-            dev_id.resize(emi.emi_cfg.emi_v51.emi_cfg.m_id_length);
-
-            mmcCARD::CIDInfo m_cid = {};
-            PraseCID(dev_id, m_cid, is_ufs);
-
-            emi.index = get_hex(i);
-            emi.flash_id = dev_id.toHex().data();
-            emi.manufacturer_id = m_cid.ManufacturerId;
-            emi.manufacturer = m_cid.Manufacturer;
-            emi.ProductName = m_cid.ProductName;
-            emi.OEMApplicationId = m_cid.OEMApplicationId;
-            emi.CardBGA = m_cid.CardBGA;
-            emi.dram_type = get_dram_type(emi.emi_cfg.emi_v51.emi_cfg.m_type);
-            emi.dram_size = get_unit(emi.emi_cfg.emi_v51.emi_cfg.m_dram_rank_size[0] +
-                    emi.emi_cfg.emi_v51.emi_cfg.m_dram_rank_size[1] +
-                    emi.emi_cfg.emi_v51.emi_cfg.m_dram_rank_size[2] +
-                    emi.emi_cfg.emi_v51.emi_cfg.m_dram_rank_size[3]);
-        }
-        else
-        {
-            qInfo().noquote() << qstr("EMI version not supported{%0}").arg(get_hex(emi_ver));
-            return 0;
-        }
+    if (m_layout->rank_width == sizeof(qlong))
+    {
+        for (qsizetype rank = 0; rank < 4; rank++)
+            emi.dram_size += get_field<qlong>(emi_cfg, m_layout->rank_off + rank * sizeof(qlong));
+    }
+    else
+    {
+        quint rank_size = 0; //!32bit rank sizes add up as quint.
+        for (qsizetype rank = 0; rank < 4; rank++)
+            rank_size += get_field<quint>(emi_cfg, m_layout->rank_off + rank * sizeof(quint));
+        emi.dram_size = rank_size;
+    }
 
-        if (!emi.flash_id.size())
-            continue;
+    emis.push_back(emi);
+}
 
-        emis.push_back(emi);
-    }
+void EMIParser::RenderEMI(const mtkPreloader::MTKEMIInfo &emi, const qbyte &emi_blob, mtkPreloader::MTKEMIText &emi_text)
+{
+    qbyte dev_id((const char*)emi.flash_id, emi.id_len);
+
+    mmcCARD::CIDData cid = {};
+    DecodeCID(emi.flash_id, emi.id_len, emi.is_ufs, cid);
+    mmcCARD::CIDInfo m_cid = {};
+    RenderCID(cid, m_cid);
+
+    emi_text.index = get_hex(emi.index);
+    emi_text.flash_id = dev_id.toHex().data();
+    emi_text.manufacturer_id = m_cid.ManufacturerId;
+    emi_text.manufacturer = m_cid.Manufacturer;
+    emi_text.ProductName = m_cid.ProductName;
+    emi_text.OEMApplicationId = m_cid.OEMApplicationId;
+    emi_text.CardBGA = m_cid.CardBGA;
+    emi_text.dram_type = get_dram_type(emi.dram_type);
+    emi_text.dram_size = get_unit(emi.dram_size);
+    emi_text.m_emi_ver = emi.emi_ver;
+
+    //!records past the blob end were decoded as zeros.
+    emi_text.m_emi_info = emi_blob.mid(emi.blob_off, emi.cfg_len);
+    emi_text.m_emi_info.append(qbyte(emi.cfg_len - emi_text.m_emi_info.size(), 0x00));
+}
 
-    return 0;
+void EMIParser::log(const qstr &msg)
+{
+    m_log << msg;
 }
 
 qstr EMIParser::GetEMIFlashDev(qbyte emi_buf)
+{
+    EMIAnchors anchors = {};
+    FindEMIAnchors(emi_buf, anchors);
+    return GetEMIFlashDev(emi_buf, anchors);
+}
+
+qstr EMIParser::GetEMIFlashDev(const qbyte &emi_buf, const EMIAnchors &anchors)
 {
     qstr emi_dev = {"MT6752"};
-    qbyte serach0("AND_ROMINFO_v");
-    qsizetype idx0 = emi_buf.indexOf(serach0);
+    qsizetype idx0 = anchors.rom_info;
     if (idx0 != -1)
         emi_dev = emi_buf.mid(idx0 + 20, 6);
 
     if (emi_dev == "MT6752")
     {
         qbyte serach1("bootable/bootloader/preloader/platform/mt");
-        qsizetype idx1 = emi_buf.indexOf(serach1);
+        qsizetype idx1 = anchors.platform_path;
         if (idx1 != -1)
             emi_dev = emi_buf.mid(idx1 + serach1.length() - 2, 6);
 
         qbyte serach2("preloader_");
-        qsizetype idx2 = emi_buf.indexOf(serach2);
+        qsizetype idx2 = anchors.pl_name;
         if (idx2 != -1)
         {
-            qstr emi_dev = emi_buf.mid(idx2 + serach2.length(), sizeof(quint));
-            QRegExp regex0("67(\\d+)");
-            if (regex0.indexIn(emi_dev)!= -1)
-            {
-                qsizetype dev_id = regex0.cap(1).toInt();
-                emi_dev = qstr("MT67%0").arg(dev_id);
-            }
-
-            QRegExp regex1("65(\\d+)");
-            if (regex1.indexIn(emi_dev)!= -1)
-            {
-                qsizetype dev_id = regex1.cap(1).toInt();
-                emi_dev = qstr("MT65%0").arg(dev_id);
-            }
+            qstr pl_dev = get_pl_platform(emi_buf.constData() + idx2 + serach2.length(),
+                                          qMin<qsizetype>(sizeof(quint), emi_buf.size() - idx2 - serach2.length()));
+            if (!pl_dev.isEmpty())
+                emi_dev = pl_dev;
         }
     }
 
-    if (emi_dev == "MT6752" && emi_buf.contains(MTK_BLOADER_INFO_BEGIN))
+    if (emi_dev == "MT6752" && anchors.bldr_ver != -1)
     {
-        qbyte emi_tag = emi_buf.mid(emi_buf.indexOf(MTK_BLOADER_INFO_BEGIN), 0x14);
-
-        if (emi_tag == "MTK_BLOADER_INFO_v00")
-            emi_dev = "MT6595/MT6797";
-        if (emi_tag == "MTK_BLOADER_INFO_v04")
-            emi_dev = "MT6516";
-        if (emi_tag == "MTK_BLOADER_INFO_v07")
-            emi_dev = "MT6573";
-        if (emi_tag == "MTK_BLOADER_INFO_v08")
-            emi_dev = "MT6575/MT6577";
-        if (emi_tag == "MTK_BLOADER_INFO_v10")
-            emi_dev = "MT6589/MT8135";
-        if(emi_tag == "MTK_BLOADER_INFO_v11")
-            emi_dev = "MT6572";
-        if (emi_tag == "MTK_BLOADER_INFO_v12")
-            emi_dev = "MT6582";
-        if (emi_tag == "MTK_BLOADER_INFO_v13")
-            emi_dev = "MT6592/MT8127";
-        if (emi_tag == "MTK_BLOADER_INFO_v20")
-            emi_dev = "MT6735";
-        if (emi_tag == "MTK_BLOADER_INFO_v21")
-            emi_dev = "MT6580";
-        if (emi_tag == "MTK_BLOADER_INFO_v22")
-            emi_dev = "MT6755";
-        if (emi_tag == "MTK_BLOADER_INFO_v25")
-            emi_dev = "MT6757";
-        if (emi_tag == "MTK_BLOADER_INFO_v27")
-            emi_dev = "MT6570";
-        if (emi_tag == "MTK_BLOADER_INFO_v28")
-            emi_dev = "MT8167";
-        if (emi_tag == "MTK_BLOADER_INFO_v30")
-            emi_dev = "MT6763";
-        if (emi_tag == "MTK_BLOADER_INFO_v31")
-            emi_dev = "MT6758";
-        if (emi_tag == "MTK_BLOADER_INFO_v32")
-            emi_dev = "MT6739";
-        if (emi_tag == "MTK_BLOADER_INFO_v35")
-            emi_dev = "MT6765";
-        if (emi_tag == "MTK_BLOADER_INFO_v36")
-            emi_dev = "MT6771";
-        if (emi_tag == "MTK_BLOADER_INFO_v38")
-            emi_dev = "MT6761";
-        if (emi_tag == "MTK_BLOADER_INFO_v39")
-            emi_dev = "MT6779";
-        if (emi_tag == "MTK_BLOADER_INFO_v40")
-            emi_dev = "MT6768";
-        if (emi_tag == "MTK_BLOADER_INFO_v45")
-            emi_dev = "MT6785";
-        if (emi_tag == "MTK_BLOADER_INFO_v46")
-            emi_dev = "MT6883/MT6885/MT6889";
-        if (emi_tag == "MTK_BLOADER_INFO_v47")
-            emi_dev = "MT6873/MT6875";
-        if (emi_tag == "MTK_BLOADER_INFO_v49")
-            emi_dev = "MT6853";
-        if (emi_tag == "MTK_BLOADER_INFO_v51")
-            emi_dev = "MT6893";
-        if (emi_tag == "MTK_BLOADER_INFO_v52")
-            emi_dev = "MT6833";
-        if (emi_tag == "MTK_BLOADER_INFO_v54")
-            emi_dev = "MT6877";
+        const char *platform = get_emi_platform(anchors.bldr_ver);
+        if (platform)
+            emi_dev = platform;
     }
 
     return emi_dev.toUpper();
@@ -1095,79 +522,98 @@ qstr EMIParser::GetEMIFlashDev(qbyte emi_buf)
 
 void EMIParser::PraseCID(qbyte raw_cid, mmcCARD::CIDInfo &cid_info, bool ufs_id)
 {
+    mmcCARD::CIDData cid = {};
+    DecodeCID((const qchar*)raw_cid.constData(), raw_cid.size(), ufs_id, cid);
+    RenderCID(cid, cid_info);
+}
+
+void EMIParser::DecodeCID(const qchar *raw_cid, qsizetype len, bool ufs_id, mmcCARD::CIDData &cid)
+{
+    qchar raw[0x10] = {}; //!short ids read as zero padded
+    len = qBound<qsizetype>(0, len, sizeof(raw));
+    memcpy(raw, raw_cid, len);
+
+    cid = {};
+    cid.is_ufs = ufs_id;
+
     if (ufs_id)
     {
-        if (raw_cid.startsWith("KM"))
-        {
-            cid_info.Manufacturer = "Samsung";
-            cid_info.ManufacturerId = "0x1CE"; //wmanufacturerid
-        }
-        else if (raw_cid.startsWith("H9"))
-        {
-            cid_info.Manufacturer = "SkHynix";
-            cid_info.ManufacturerId = "0x1AD";
-        }
-        else if (raw_cid.startsWith("MT"))
-        {
-            cid_info.Manufacturer = "Micron";
-            cid_info.ManufacturerId = "0x12C";
-        }
-        else if (raw_cid.startsWith("Z"))
-        {
-            cid_info.Manufacturer = "Micron";
-            cid_info.ManufacturerId = "0x02C";
-        }
-        else if (raw_cid.startsWith("TH"))
+        cid.ufs_vendor = get_ufs_vendor(raw, len); //!only the id bytes, not the padding
+        cid.oid = (len > 1)? (raw[0] << 8 | raw[1]): raw[0];
+        memcpy(cid.pnm, raw, sizeof(raw));
+        return;
+    }
+
+    mmcCARD::emmc_card_info_cid_t m_cid;
+    memcpy(&m_cid, raw, sizeof(m_cid));
+
+    cid.mid = m_cid.mid;
+    cid.cbx = m_cid.cbx;
+    cid.oid = m_cid.oid;
+    cid.prv = m_cid.pdrv;
+    cid.mdt = m_cid.mdt;
+    memcpy(cid.psn, &m_cid.psn0, sizeof(cid.psn));
+
+    //!pnm0..pnm5, whitespace trimmed at both ends and cut at the first NUL.
+    const char *pnm = (const char*)&m_cid.pnm0;
+    qsizetype from = 0, to = 6;
+    while (from < to && isspace((qchar)pnm[from]))
+        from++;
+    while (to > from && isspace((qchar)pnm[to - 1]))
+        to--;
+    memcpy(cid.pnm, pnm + from, to - from);
+}
+
+void EMIParser::RenderCID(const mmcCARD::CIDData &cid, mmcCARD::CIDInfo &cid_info)
+{
+    cid_info = {};
+    cid_info.ProductName = cid.pnm;
+
+    if (cid.is_ufs)
+    {
+        if (cid.ufs_vendor)
         {
-            cid_info.Manufacturer = "TOSHIBA";
-            cid_info.ManufacturerId = "0x198";
+            const UFSVendor &vendor = ufs_vendors[cid.ufs_vendor - 1];
+            cid_info.Manufacturer = vendor.name;
+            if (vendor.mfr_id)
+                cid_info.ManufacturerId = qstr("0x%0").arg(qstr::number(vendor.mfr_id, 0x10).toUpper().rightJustified(3, '0')); //wmanufacturerid
         }
-
-        cid_info.ProductName = raw_cid.data();
-        cid_info.OEMApplicationId = get_hex(raw_cid.toHex().mid(0, 4).toUShort(0, 0x10));//0000;
+        cid_info.OEMApplicationId = get_hex(cid.oid);
         cid_info.CardBGA = "eUFS";
+        return;
     }
-    else
+
+    cid_info.ManufacturerId = get_hex(cid.mid);
+    cid_info.Manufacturer = get_card_mfr_id(cid.mid);
+    cid_info.CardBGA = get_card_type(cid.cbx);
+    cid_info.OEMApplicationId = get_hex(cid.oid);
+    cid_info.ProductRevision = qstr("%0.%1").arg(cid.prv >> 4).arg(cid.prv & 0xf);
+    cid_info.ProductSerialNumber = qstr("0x%0").arg(qbyte::fromRawData((const char*)cid.psn, sizeof(cid.psn)).toHex().data());
+    cid_info.ManufacturingDate = qstr("%0/%1").arg(cid.mdt >> 4).arg((cid.mdt & 0xf) + 2013); //todo
+}
+
+//! version => layout and platform, built once from emi_layouts and emi_platforms.
+static const struct EMIVersionIndex
+{
+    const mtkPreloader::EMILayout *layout[0x100];
+    const char *platform[0x100];
+    EMIVersionIndex() : layout(), platform()
     {
-        mmcCARD::emmc_card_info_cid_t m_cid = {};
-        memset(&m_cid, 0x00, sizeof(m_cid));
-        memcpy(&m_cid, raw_cid.data(), sizeof(m_cid));
-
-        cid_info = {};
-        struct {
-            char pnm[6]{0x00};
-        } _pnm = {};
-        memcpy(&_pnm.pnm[0], &m_cid.pnm0, sizeof(_pnm.pnm[0]));
-        memcpy(&_pnm.pnm[1], &m_cid.pnm1, sizeof(_pnm.pnm[1]));
-        memcpy(&_pnm.pnm[2], &m_cid.pnm2, sizeof(_pnm.pnm[2]));
-        memcpy(&_pnm.pnm[3], &m_cid.pnm3, sizeof(_pnm.pnm[3]));
-        memcpy(&_pnm.pnm[4], &m_cid.pnm4, sizeof(_pnm.pnm[4]));
-        memcpy(&_pnm.pnm[5], &m_cid.pnm5, sizeof(_pnm.pnm[5]));
-        QByteArray pnm((char*)&_pnm, sizeof(_pnm));
-
-        struct {
-            char psn[4]{0x00};
-        } _psn = {};
-        memcpy(&_psn.psn[0], &m_cid.psn0, sizeof(_psn.psn[0]));
-        memcpy(&_psn.psn[1], &m_cid.psn1, sizeof(_psn.psn[1]));
-        memcpy(&_psn.psn[2], &m_cid.psn2, sizeof(_psn.psn[2]));
-        memcpy(&_psn.psn[3], &m_cid.psn3, sizeof(_psn.psn[3]));
-        QByteArray psn((char*)&_psn, sizeof(_psn));
-
-        QString prv_min(QString().sprintf("%d", (qchar)(m_cid.pdrv >> 4)));
-        QString prv_maj(QString().sprintf("%d", (qchar)(m_cid.pdrv & 0xf)));
-        QString mdt_month(QString().sprintf("%d", (qchar)(m_cid.mdt >> 4)));
-        QString mdt_year(QString().sprintf("%d", (qshort)(m_cid.mdt & 0xf) + 2013)); //todo
-
-        cid_info.ManufacturerId = get_hex(m_cid.mid);
-        cid_info.Manufacturer = get_card_mfr_id(m_cid.mid);
-        cid_info.CardBGA = get_card_type(m_cid.cbx);
-        cid_info.OEMApplicationId = get_hex(m_cid.oid);
-        cid_info.ProductName = QString("%0").arg(pnm.trimmed().data());
-        cid_info.ProductRevision = QString(prv_min + "." + prv_maj);
-        cid_info.ProductSerialNumber = QString("0x%0").arg(psn.toHex().data());
-        cid_info.ManufacturingDate = QString(mdt_month + "/" + mdt_year);
+        for (const mtkPreloader::EMILayout &emi_layout : emi_layouts)
+            layout[emi_layout.emi_ver] = &emi_layout;
+        for (const EMIPlatform &emi_platform : emi_platforms)
+            platform[emi_platform.emi_ver] = emi_platform.platform;
     }
+} emi_index;
+
+const mtkPreloader::EMILayout *EMIParser::get_emi_layout(quint8 emi_ver)
+{
+    return emi_index.layout[emi_ver];
+}
+
+const char *EMIParser::get_emi_platform(quint8 emi_ver)
+{
+    return emi_index.platform[emi_ver];
 }
 
 qstr EMIParser::get_pl_sig_type(qchar sig_type)
@@ -1189,6 +635,48 @@ qstr EMIParser::get_pl_sig_type(qchar sig_type)
     }
 }
 
+//!leftmost "<family><digits>" like QRegExp("67(\\d+)"), the digits valued like QString::toInt:
+//!leading zeros dropped, 0 past 0x7fffffff. at most 10 significant digits are summed, no overflow.
+static bool find_pl_family(const char *name, qsizetype len, const char *family, qlong &dev_id)
+{
+    for (qsizetype idx = 0; idx + 2 < len; idx++)
+    {
+        if (name[idx] != family[0] || name[idx + 1] != family[1])
+            continue;
+
+        qsizetype end = idx + 2;
+        qsizetype digits = 0;
+        dev_id = 0;
+        for (; end < len && name[end] >= '0' && name[end] <= '9'; end++)
+        {
+            if (!dev_id && name[end] == '0')
+                continue;
+            if (++digits <= 10)
+                dev_id = dev_id * 10 + (name[end] - '0');
+        }
+        if (end == idx + 2)
+            continue;
+
+        if (digits > 10 || dev_id > 0x7fffffff)
+            dev_id = 0;
+        return 1;
+    }
+    return 0;
+}
+
+qstr EMIParser::get_pl_platform(const char *pl_name, qsizetype len)
+{
+    //! the old two QRegExp passes: "67<digits>" => MT67<n>, then "65<digits>" is searched in
+    //! that result (or the name when it had no 67), => MT65<n>.
+    qlong dev_id = 0;
+    bool mt67 = find_pl_family(pl_name, len, "67", dev_id);
+    qbyte pl_dev = mt67? qbyte("MT67") + qbyte::number(dev_id): qbyte(pl_name, len);
+
+    if (find_pl_family(pl_dev.constData(), pl_dev.size(), "65", dev_id))
+        return qstr("MT65%0").arg(dev_id);
+    return mt67? qstr(pl_dev): qstr();
+}
+
 qstr EMIParser::get_pl_flash_dev(qchar flash_dev)
 {
     switch (flash_dev)
@@ -1214,41 +702,41 @@ qstr EMIParser::get_pl_flash_dev(qchar flash_dev)
     }
 }
 
-qstr EMIParser::get_dram_type(quint16 type)
+qstr EMIParser::get_dram_type(mtkPreloader::EMIDramType type)
 {
     switch (type)
     {
-        case 0x001:
+        case mtkPreloader::DRAM_DISCRETE_DDR1:
             return "Discrete DDR1";
-        case 0x002:
+        case mtkPreloader::DRAM_DISCRETE_LPDDR2:
             return "Discrete LPDDR2";
-        case 0x003:
+        case mtkPreloader::DRAM_DISCRETE_LPDDR3:
             return "Discrete LPDDR3";
-        case 0x004:
+        case mtkPreloader::DRAM_DISCRETE_PCDDR3:
             return "Discrete PCDDR3";
-        case 0x101:
+        case mtkPreloader::DRAM_MCP_NAND_DDR1:
             return "MCP(NAND+DDR1)";
-        case 0x102:
+        case mtkPreloader::DRAM_MCP_NAND_LPDDR2:
             return "MCP(NAND+LPDDR2)";
-        case 0x103:
+        case mtkPreloader::DRAM_MCP_NAND_LPDDR3:
             return "MCP(NAND+LPDDR3)";
-        case 0x104:
+        case mtkPreloader::DRAM_MCP_NAND_PCDDR3:
             return "MCP(NAND+PCDDR3)";
-        case 0x201:
+        case mtkPreloader::DRAM_MCP_EMMC_DDR1:
             return "MCP(eMMC+DDR1)";
-        case 0x202:
+        case mtkPreloader::DRAM_MCP_EMMC_LPDDR2:
             return "MCP(eMMC+LPDDR2)";
-        case 0x203:
+        case mtkPreloader::DRAM_MCP_EMMC_LPDDR3:
             return "MCP(eMMC+LPDDR3)";
-        case 0x204:
+        case mtkPreloader::DRAM_MCP_EMMC_PCDDR3:
             return "MCP(eMMC+PCDDR3)";
-        case 0x205:
+        case mtkPreloader::DRAM_MCP_EMMC_LPDDR4:
             return "MCP(eMMC+LPDDR4)";
-        case 0x206:
+        case mtkPreloader::DRAM_MCP_EMMC_LPDDR4X:
             return "MCP(eMMC+LPDR4X)";
-        case 0x306:
+        case mtkPreloader::DRAM_UMCP_EUFS_LPDDR4X:
             return "uMCP(eUFS+LPDDR4X)";
-        case 0x308:
+        case mtkPreloader::DRAM_UMCP_EUFS_LPDDR5:
             return "uMCP(eUFS+LPDDR5)";
         default:
             return qstr("%0:Unknown").arg(get_hex(type));
@@ -1288,6 +776,40 @@ qstr EMIParser::get_card_mfr_id(qchar mid)
     }
 }
 
+qchar EMIParser::get_ufs_vendor(const qchar *part_no, qsizetype len)
+{
+    //! first byte => [begin, end) of ufs_vendors, one walk down a single group.
+    static const struct UFSVendorIndex
+    {
+        qchar begin[0x100];
+        qchar end[0x100];
+        UFSVendorIndex() : begin(), end()
+        {
+            for (qchar idx = 0; idx < sizeof(ufs_vendors) / sizeof(ufs_vendors[0]); idx++)
+            {
+                qchar first = ufs_vendors[idx].prefix[0];
+                if (begin[first] == end[first])
+                    begin[first] = idx;
+                end[first] = idx + 1;
+            }
+        }
+    } vendor_index;
+
+    if (len <= 0)
+        return 0;
+
+    for (qchar idx = vendor_index.begin[part_no[0]]; idx < vendor_index.end[part_no[0]]; idx++)
+    {
+        const char *prefix = ufs_vendors[idx].prefix;
+        qsizetype pos = 1;
+        while (prefix[pos] && pos < len && prefix[pos] == (char)part_no[pos])
+            pos++;
+        if (!prefix[pos])
+            return idx + 1;
+    }
+    return 0;
+}
+
 qstr EMIParser::get_card_type(qchar type)
 {
     switch (type)
@@ -2,6 +2,42 @@
 #define PRELOADER_PARSER_H
 
 #include "emi_structures.h"
+#include "emi_scan.h"
+
+#define EMI_READ_CHUNK 0x10000 //!64K
+#define EMI_MAX_RESERVE 0x2000000 //!32M, gfh lengths past this are grown into, not trusted
+#define EMI_MAX_LEN 0x1000 //!MAX_EMI_LEN
+
+class EMIBlobSink;
+class EMIResultCache;
+
+//! read-only view of an input device. files are memory mapped, anything else
+//! (pipe, buffer, ...) is read on demand in EMI_READ_CHUNK pieces, a dump streamed
+//! from a slow reader is only consumed as far as the parser asks for.
+class EMIImage
+{
+public:
+    EMIImage(QIODevice &emi_dev);
+    ~EMIImage();
+
+    const qbyte &view() const { return m_view; }
+    bool mapped() const { return m_map != nullptr; }
+
+    //!makes the first len bytes (or all there is) available, returns view().size() >= len.
+    bool Fill(qint64 len);
+    //!nothing past len is read or shown, streams reserve it up front.
+    void Limit(qint64 len);
+private:
+    Q_DISABLE_COPY(EMIImage)
+
+    QIODevice *m_dev{nullptr};
+    QFileDevice *m_file{nullptr};
+    uchar *m_map{nullptr};
+    qint64 m_map_len{0};
+    qint64 m_limit{std::numeric_limits<int>::max()}; //!QByteArray limit
+    bool m_eof{0};
+    qbyte m_view{};
+};
 
 class EMIParser
 {
@@ -9,14 +45,48 @@ public:
     EMIParser(){}
     ~EMIParser(){};
 
-    static bool PrasePreloader(QIODevice &emi_dev, QVector<mtkPreloader::MTKEMIInfo> &emis);
+    //!one parser per thread, the static helpers are stateless.
+    bool PrasePreloader(QIODevice &emi_dev, QVector<mtkPreloader::MTKEMIInfo> &emis);
+    //!the two halves of PrasePreloader, the batch pipeline runs them on different threads.
+    //!Locate: magic check, anchor scan, header & blob copy; 0 => nothing to decode.
+    bool Locate(QIODevice &emi_dev);
+    void Decode(QVector<mtkPreloader::MTKEMIInfo> &emis); //!records of the located blob
+    qint64 scanned() const { return m_scanned; } //!image bytes Locate looked at
+    const QStringList &messages() const { return m_log; }
+    const mtkPreloader::MTKEMIHeader &header() const { return m_header; }
+    const qbyte &blob() const { return m_blob; } //!MTK_BLOADER_INFO, MTKEMIInfo::blob_off is relative to it
+    void setBlobSink(EMIBlobSink *sink) { m_sink = sink; }
+    void setCache(EMIResultCache *cache) { m_cache = cache; }
+
+    static void RenderEMI(const mtkPreloader::MTKEMIInfo &emi, const qbyte &emi_blob, mtkPreloader::MTKEMIText &emi_text);
     static void PraseCID(qbyte raw_cid, mmcCARD::CIDInfo &cid_info, bool ufs_id = 0);
+    static void DecodeCID(const qchar *raw_cid, qsizetype len, bool ufs_id, mmcCARD::CIDData &cid);
+    static void RenderCID(const mmcCARD::CIDData &cid, mmcCARD::CIDInfo &cid_info);
     static qstr GetEMIFlashDev(qbyte emi_buf);
+    static qstr GetEMIFlashDev(const qbyte &emi_buf, const EMIAnchors &anchors);
 private:
+    void log(const qstr &msg);
+    bool validate_blob(const mtkPreloader::EMILayout *emi_layout);
+    void decode_record(const char *emi_cfg, quint index, qsizetype blob_off, QVector<mtkPreloader::MTKEMIInfo> &emis) const;
+
+    QStringList m_log{};
+    mtkPreloader::MTKEMIHeader m_header{};
+    qbyte m_blob{};
+    qint64 m_scanned{0};
+    const mtkPreloader::EMILayout *m_layout{nullptr}; //!set once the blob validated
+    quint m_records{0}; //!num_records clamped to the blob
+    quint m_full_records{0}; //!records holding a whole emi_cfg
+    EMIBlobSink *m_sink{nullptr};
+    EMIResultCache *m_cache{nullptr};
+
+    static const mtkPreloader::EMILayout *get_emi_layout(quint8 emi_ver);
+    static const char *get_emi_platform(quint8 emi_ver);
     static qstr get_pl_sig_type(qchar sig_type);
+    static qstr get_pl_platform(const char *pl_name, qsizetype len);
     static qstr get_pl_flash_dev(qchar flash_dev);
-    static qstr get_dram_type(quint16 type);
+    static qstr get_dram_type(mtkPreloader::EMIDramType type);
     static qstr get_card_mfr_id(qchar mid);
+    static qchar get_ufs_vendor(const qchar *part_no, qsizetype len);
     static qstr get_card_type(qchar type);
     static qstr get_unit(qlong bytes);
     static qstr get_hex(qlong num);